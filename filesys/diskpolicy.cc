@@ -0,0 +1,154 @@
+// diskpolicy.cc
+//	Routines to choose which waiting request the disk serves next.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "diskpolicy.h"
+#include "disk.h"
+
+//----------------------------------------------------------------------
+// DiskPolicy::Create
+// 	Make a policy of the given type.
+//----------------------------------------------------------------------
+
+DiskPolicy *
+DiskPolicy::Create(DiskPolicyType type)
+{
+    switch (type) {
+      case FCFSDisk:  return new FCFSDiskPolicy();
+      case SSTFDisk:  return new SSTFDiskPolicy();
+      case SCANDisk:  return new SCANDiskPolicy();
+      case CLOOKDisk: return new CLOOKDiskPolicy();
+    }
+    ASSERTNOTREACHED();
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// DiskPolicy::ParseType
+// 	Convert the name of a policy, as given to "-disk", into its type.
+//	Returns FALSE if there is no such policy.
+//----------------------------------------------------------------------
+
+bool
+DiskPolicy::ParseType(char *name, DiskPolicyType *type)
+{
+    if (strcmp(name, "fcfs") == 0) {
+	*type = FCFSDisk;
+    } else if (strcmp(name, "sstf") == 0) {
+	*type = SSTFDisk;
+    } else if (strcmp(name, "scan") == 0) {
+	*type = SCANDisk;
+    } else if (strcmp(name, "clook") == 0) {
+	*type = CLOOKDisk;
+    } else {
+	return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Nearest
+// 	Return the request in "queue" with the lowest sector at or above
+//	"from" (if "up"), or the highest at or below it; NULL if there is
+//	none.  Of requests for the same sector, the first to come wins.
+//----------------------------------------------------------------------
+
+static DiskRequest *
+Nearest(List<DiskRequest *> *queue, int from, bool up)
+{
+    ListIterator<DiskRequest *> iter(queue);
+    DiskRequest *best = NULL;
+
+    for (; !iter.IsDone(); iter.Next()) {
+	DiskRequest *request = iter.Item();
+
+	if (up ? (request->sector < from) : (request->sector > from)) {
+	    continue;
+	}
+	if (best == NULL || (up ? (request->sector < best->sector)
+				: (request->sector > best->sector))) {
+	    best = request;
+	}
+    }
+    return best;
+}
+
+//----------------------------------------------------------------------
+// FCFSDiskPolicy::RemoveNext
+// 	The request that has waited longest.
+//----------------------------------------------------------------------
+
+DiskRequest *
+FCFSDiskPolicy::RemoveNext(List<DiskRequest *> *queue, int head, Disk *disk)
+{
+    return queue->RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// SSTFDiskPolicy::RemoveNext
+// 	The request the disk says it would take the least time to do,
+//	from where the head is now.
+//----------------------------------------------------------------------
+
+DiskRequest *
+SSTFDiskPolicy::RemoveNext(List<DiskRequest *> *queue, int head, Disk *disk)
+{
+    ListIterator<DiskRequest *> iter(queue);
+    DiskRequest *best = NULL;
+    int bestTime = 0;
+
+    for (; !iter.IsDone(); iter.Next()) {
+	DiskRequest *request = iter.Item();
+	int time = disk->ComputeLatency(request->sector, request->writing);
+
+	if (best == NULL || time < bestTime) {
+	    best = request;
+	    bestTime = time;
+	}
+    }
+    queue->Remove(best);
+    return best;
+}
+
+//----------------------------------------------------------------------
+// SCANDiskPolicy::RemoveNext
+// 	The next request in the direction the head is sweeping, or if
+//	there are none, the next one the other way, turning around.
+//----------------------------------------------------------------------
+
+DiskRequest *
+SCANDiskPolicy::RemoveNext(List<DiskRequest *> *queue, int head, Disk *disk)
+{
+    DiskRequest *next = Nearest(queue, head, up);
+
+    if (next == NULL) {
+	up = !up;
+	DEBUG(dbgDisk, "Disk head turns at sector " << head);
+	next = Nearest(queue, head, up);
+    }
+    queue->Remove(next);
+    return next;
+}
+
+//----------------------------------------------------------------------
+// CLOOKDiskPolicy::RemoveNext
+// 	The next request above the head, or if there are none, the lowest
+//	one.
+//----------------------------------------------------------------------
+
+DiskRequest *
+CLOOKDiskPolicy::RemoveNext(List<DiskRequest *> *queue, int head, Disk *disk)
+{
+    DiskRequest *next = Nearest(queue, head, TRUE);
+
+    if (next == NULL) {
+	next = Nearest(queue, 0, TRUE);
+    }
+    queue->Remove(next);
+    return next;
+}
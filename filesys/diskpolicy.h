@@ -0,0 +1,112 @@
+// diskpolicy.h
+//	Data structures for the disk scheduling policies: the ways of
+//	choosing which waiting request the disk serves next.
+//
+//	The disk can only do one request at a time, so while it is busy
+//	the others wait in SynchDisk's request queue.  When it finishes,
+//	a policy picks the next one, knowing where the head is (the sector
+//	of the request just done).  Serving them in the order they came is
+//	fair, but can send the head back and forth across the disk; the
+//	other policies keep it moving short distances.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef DISKPOLICY_H
+#define DISKPOLICY_H
+
+#include "copyright.h"
+#include "list.h"
+
+class Disk;
+class Semaphore;
+
+// The policies the kernel can be booted with (see "-disk").
+enum DiskPolicyType { FCFSDisk, SSTFDisk, SCANDisk, CLOOKDisk };
+
+// A request waiting for the disk.  It may be for several consecutive
+// sectors, which the disk does one after another, without serving any
+// other request in between.
+
+class DiskRequest {
+  public:
+    int sector;				// which sector
+    int count;				// sectors to do, from that one on
+    char *data;				// where to read them to, or write
+					// them from
+    bool writing;
+    Semaphore *done;			// V'd when the disk has done it
+};
+
+// The following class defines the interface every disk scheduling
+// policy provides.  It is called with interrupts disabled.
+
+class DiskPolicy {
+  public:
+    DiskPolicy() {}
+    virtual ~DiskPolicy() {}
+
+    virtual char *getName() = 0;	// for debugging
+
+    virtual DiskRequest *RemoveNext(List<DiskRequest *> *queue,
+		int head, Disk *disk) = 0;
+				// take the request to serve next off the
+				// queue (which isn't empty, and is in
+				// arrival order); the head is at sector
+				// "head" of "disk"
+
+    static DiskPolicy *Create(DiskPolicyType type);
+				// make a policy of the given type
+    static bool ParseType(char *name, DiskPolicyType *type);
+				// name given to "-disk" -> policy type
+};
+
+// First come, first served.
+
+class FCFSDiskPolicy : public DiskPolicy {
+  public:
+    char *getName() { return "FCFS"; }
+    DiskRequest *RemoveNext(List<DiskRequest *> *queue, int head,
+		Disk *disk);
+};
+
+// Shortest seek time first: the request the disk can get to soonest,
+// counting rotation (and the track buffer), as well as the seek.
+
+class SSTFDiskPolicy : public DiskPolicy {
+  public:
+    char *getName() { return "SSTF"; }
+    DiskRequest *RemoveNext(List<DiskRequest *> *queue, int head,
+		Disk *disk);
+};
+
+// The elevator: the head sweeps across the disk in one direction,
+// serving requests in sector order, then turns around.  It turns at
+// the last request rather than the edge of the disk, as there is
+// nothing to gain by going on.
+
+class SCANDiskPolicy : public DiskPolicy {
+  public:
+    SCANDiskPolicy() { up = TRUE; }
+
+    char *getName() { return "SCAN"; }
+    DiskRequest *RemoveNext(List<DiskRequest *> *queue, int head,
+		Disk *disk);
+
+  private:
+    bool up;				// sweeping towards higher sectors?
+};
+
+// Circular LOOK: like the elevator, but only serving requests on the
+// way up; after the highest one, the head goes straight back to the
+// lowest.  Requests wait for at most one sweep, wherever they are.
+
+class CLOOKDiskPolicy : public DiskPolicy {
+  public:
+    char *getName() { return "C-LOOK"; }
+    DiskRequest *RemoveNext(List<DiskRequest *> *queue, int head,
+		Disk *disk);
+};
+
+#endif // DISKPOLICY_H
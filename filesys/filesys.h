@@ -94,6 +94,13 @@ class FileSystem {
     }
 // *************** MP1 *************** //
 
+//  The DuplicateFile function is used for the Mmap system call: the
+//  mapping keeps the file open after the program closes "id".
+    OpenFile *DuplicateFile(OpenFileId id){
+        if(id<1 || id>20 || OpenFileTable[id-1]==NULL) return NULL;
+        return OpenFileTable[id-1]->Duplicate();
+    }
+
 
     bool Remove(char *name) { return Unlink(name) == 0; }
 
@@ -31,6 +31,9 @@ OpenFile::OpenFile(int sector)
     hdr = new FileHeader;
     hdr->FetchFrom(sector);
     seekPosition = 0;
+    nextSector = 0;
+    readAhead = MinReadAhead;
+    prefetchEnd = 0;
 }
 
 //----------------------------------------------------------------------
@@ -107,6 +110,10 @@ OpenFile::Write(char *into, int numBytes)
 //
 //	"into" -- the buffer to contain the data to be read from disk 
 //	"from" -- the buffer containing the data to be written to disk 
+//	If ReadAt starts where the last one left off (or in the sector
+//	it ended in), the reader is taken to be going through the file
+//	in order, and the sectors after these are read ahead.
+//
 //	"numBytes" -- the number of bytes to transfer
 //	"position" -- the offset within the file of the first byte to be
 //			read/written
@@ -116,7 +123,8 @@ int
 OpenFile::ReadAt(char *into, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
+    int i, firstSector, lastSector, numSectors, run;
+    bool sequential;
     char *buf;
 
     if ((numBytes <= 0) || (position >= fileLength))
@@ -128,12 +136,29 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
+    sequential = (firstSector == nextSector || firstSector == nextSector - 1);
+    if (sequential) {
+	TuneReadAhead(firstSector, lastSector);
+    }
 
-    // read in all the full and partial sectors that we need
+    // read in all the full and partial sectors that we need, each run
+    // of them that is consecutive on disk as one request
     buf = new char[numSectors * SectorSize];
-    for (i = firstSector; i <= lastSector; i++)	
-        kernel->synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
+    for (i = firstSector; i <= lastSector; i += run) {
+	run = SectorRun(i, lastSector);
+        kernel->synchDisk->ReadSectors(hdr->ByteToSector(i * SectorSize), 
+				run, &buf[(i - firstSector) * SectorSize]);
+    }
+
+    // with our own sectors read, start on the ones after them, which
+    // the disk can fetch while the caller works on these
+    if (sequential) {
+	ReadAhead(lastSector + 1);
+    } else {
+	readAhead = MinReadAhead;
+	prefetchEnd = 0;
+    }
+    nextSector = lastSector + 1;
 
     // copy the part we want
     bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
@@ -145,7 +170,7 @@ int
 OpenFile::WriteAt(char *from, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
+    int i, firstSector, lastSector, numSectors, run;
     bool firstAligned, lastAligned;
     char *buf;
 
@@ -165,23 +190,78 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     lastAligned = ((position + numBytes) == ((lastSector + 1) * SectorSize));
 
 // read in first and last sector, if they are to be partially modified
+// (straight from the disk, so as not to look like a sequential reader)
     if (!firstAligned)
-        ReadAt(buf, SectorSize, firstSector * SectorSize);	
+        kernel->synchDisk->ReadSector(hdr->ByteToSector(firstSector * SectorSize),
+				buf);
     if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-        ReadAt(&buf[(lastSector - firstSector) * SectorSize], 
-				SectorSize, lastSector * SectorSize);	
+        kernel->synchDisk->ReadSector(hdr->ByteToSector(lastSector * SectorSize),
+				&buf[(lastSector - firstSector) * SectorSize]);
 
 // copy in the bytes we want to change 
     bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
 
 // write modified sectors back
-    for (i = firstSector; i <= lastSector; i++)	
-        kernel->synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
+    for (i = firstSector; i <= lastSector; i += run) {
+	run = SectorRun(i, lastSector);
+        kernel->synchDisk->WriteSectors(hdr->ByteToSector(i * SectorSize), 
+				run, &buf[(i - firstSector) * SectorSize]);
+    }
     delete [] buf;
     return numBytes;
 }
 
+//----------------------------------------------------------------------
+// OpenFile::TuneReadAhead
+// 	A sequential reader is about to read sectors "first" to "last" of
+//	the file.  If we read ahead any of the new ones, see whether they
+//	are still in the cache: if all of them are, read further ahead
+//	next time; if not, reading ahead so far was a waste, so read less.
+//----------------------------------------------------------------------
+
+void
+OpenFile::TuneReadAhead(int first, int last)
+{
+    int from = max(first, nextSector);
+    int to = min(last, prefetchEnd - 1);
+    int hits = 0;
+
+    if (from > to) {
+	return;				// none were read ahead
+    }
+    for (int i = from; i <= to; i++) {
+	if (kernel->synchDisk->IsCached(hdr->ByteToSector(i * SectorSize))) {
+	    hits++;
+	}
+    }
+    if (hits == to - from + 1) {
+	readAhead = min(readAhead * 2, MaxReadAhead);
+    } else {
+	readAhead = max(readAhead / 2, MinReadAhead);
+    }
+    DEBUG(dbgFile, "Read ahead " << hits << " of " << to - from + 1
+		<< " hit, window now " << readAhead << " sectors");
+}
+
+//----------------------------------------------------------------------
+// OpenFile::ReadAhead
+// 	Ask for the next "readAhead" sectors of the file, from sector
+//	"from" on, to be read into the cache, skipping any that already
+//	have been asked for.
+//----------------------------------------------------------------------
+
+void
+OpenFile::ReadAhead(int from)
+{
+    int end = min(from + readAhead,
+		  divRoundUp(hdr->FileLength(), SectorSize));
+
+    for (int i = max(from, prefetchEnd); i < end; i++) {
+	kernel->synchDisk->Prefetch(hdr->ByteToSector(i * SectorSize));
+    }
+    prefetchEnd = max(prefetchEnd, end);
+}
+
 //----------------------------------------------------------------------
 // OpenFile::Length
 // 	Return the number of bytes in the file.
@@ -193,4 +273,25 @@ OpenFile::Length()
     return hdr->FileLength(); 
 }
 
+//----------------------------------------------------------------------
+// OpenFile::SectorRun
+// 	Return how many of the file's sectors, starting with sector "first"
+//	of the file and going no further than "last", are stored in
+//	consecutive sectors of the disk, so they can be read or written in
+//	one go.  Always at least one.
+//----------------------------------------------------------------------
+
+int
+OpenFile::SectorRun(int first, int last)
+{
+    int start = hdr->ByteToSector(first * SectorSize);
+    int run = 1;
+
+    while (first + run <= last
+		&& hdr->ByteToSector((first + run) * SectorSize) == start + run) {
+	run++;
+    }
+    return run;
+}
+
 #endif //FILESYS_STUB
@@ -53,6 +53,11 @@ class OpenFile {
 		}
 
     int Length() { Lseek(file, 0, 2); return Tell(file); }
+
+    OpenFile *Duplicate() { return new OpenFile(Dup(file)); }
+					// the same file, open again; every
+					// access seeks, so the two can't
+					// get in each other's way
     
   
   private:
@@ -63,6 +68,14 @@ class OpenFile {
 #else // FILESYS
 class FileHeader;
 
+// When a file is read in order, the sectors after the ones asked for
+// are read into the disk cache ahead of time.  How many depends on how
+// well it is going: the window doubles when everything read ahead was
+// still in the cache when it was wanted, and halves when it wasn't.
+
+const int MinReadAhead = 1;		// sectors read ahead, at first
+const int MaxReadAhead = 8;		// and at most
+
 class OpenFile {
   public:
     OpenFile(int sector);		// Open a file whose header is located
@@ -91,6 +104,19 @@ class OpenFile {
   private:
     FileHeader *hdr;			// Header for this file 
     int seekPosition;			// Current position within the file
+    int nextSector;			// the sector a sequential reader
+					// would want next
+    int readAhead;			// sectors to read ahead of it
+    int prefetchEnd;			// sectors before this one have
+					// already been read ahead
+
+    int SectorRun(int first, int last);	// how many of the file's sectors
+					// from "first" to "last" follow
+					// each other on disk
+    void TuneReadAhead(int first, int last);
+					// did reading ahead pay off for
+					// sectors "first" to "last"?
+    void ReadAhead(int from);		// read ahead, from sector "from" on
 };
 
 #endif // FILESYS
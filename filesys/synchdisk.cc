@@ -5,16 +5,29 @@
 //	the disk providing a synchronous interface (requests wait until
 //	the request completes).
 //
-//	Use a semaphore to synchronize the interrupt handlers with the
-//	pending requests.  And, because the physical disk can only
-//	handle one operation at a time, use a lock to enforce mutual
-//	exclusion.
+//	The physical disk can only handle one operation at a time, so
+//	requests that come while it is busy wait in a queue.  The queue
+//	is shared with the interrupt handler, which starts the next
+//	request when one finishes, so it is protected by disabling
+//	interrupts.  Each request has a semaphore for its thread to wait
+//	on until the interrupt handler says it is done.
+//
+//	In front of the disk is a cache of sectors, with a lock of its
+//	own.  It isn't held while waiting for the disk, so a request that
+//	hits in the cache needn't wait behind one that misses.  Instead,
+//	the sector being read or written back is marked busy.
+//
+//	Sectors to read ahead go on a list, protected by the cache lock,
+//	for the read ahead thread to fetch, a run at a time.  The write
+//	behind thread is woken by a semaphore, as the flush timer that
+//	V's it is an interrupt handler.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
 
 #include "copyright.h"
+#include "main.h"
 #include "synchdisk.h"
 
 
@@ -23,13 +36,31 @@
 // 	Initialize the synchronous interface to the physical disk, in turn
 //	initializing the physical disk.
 //
+//	"type" -- the order to serve waiting requests in
 //----------------------------------------------------------------------
 
-SynchDisk::SynchDisk()
+SynchDisk::SynchDisk(DiskPolicyType type)
 {
-    semaphore = new Semaphore("synch disk", 0);
-    lock = new Lock("synch disk lock");
     disk = new Disk(this);
+    policy = DiskPolicy::Create(type);
+    queue = new List<DiskRequest *>;
+    active = NULL;
+    head = 0;
+    for (int i = 0; i < SectorCacheSize; i++) {
+	cache[i].sector = -1;
+	cache[i].valid = cache[i].dirty = cache[i].busy = FALSE;
+	cache[i].lastUsed = 0;
+    }
+    cacheLock = new Lock("sector cache lock");
+    cacheReady = new Condition("sector cache ready");
+    useCount = 0;
+    prefetches = new List<int>;
+    prefetchWanted = new Condition("read ahead wanted");
+    prefetcher = NULL;
+    numDirty = 0;
+    flushWanted = new Semaphore("write behind wanted", 0);
+    flushTimer = new FlushTimer(flushWanted);
+    flusher = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -41,14 +72,20 @@ SynchDisk::SynchDisk()
 SynchDisk::~SynchDisk()
 {
     delete disk;
-    delete lock;
-    delete semaphore;
+    delete policy;
+    delete queue;
+    delete cacheLock;
+    delete cacheReady;
+    delete prefetches;
+    delete prefetchWanted;
+    delete flushWanted;
+    delete flushTimer;
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::ReadSector
 // 	Read the contents of a disk sector into a buffer.  Return only
-//	after the data has been read.
+//	after the data has been read -- from the cache, if it is there.
 //
 //	"sectorNumber" -- the disk sector to read
 //	"data" -- the buffer to hold the contents of the disk sector
@@ -57,16 +94,27 @@ SynchDisk::~SynchDisk()
 void
 SynchDisk::ReadSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->ReadRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    CachedSector *entry;
+
+    cacheLock->Acquire();
+    entry = GetSector(sectorNumber);
+    if (!entry->valid) {
+	cacheLock->Release();		// it's busy, so nobody else will
+	DiskRead(sectorNumber, entry->data);	// touch it meanwhile
+	cacheLock->Acquire();
+	entry->valid = TRUE;
+    }
+    bcopy(entry->data, data, SectorSize);
+    PutSector(entry);
+    cacheLock->Release();
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::WriteSector
-// 	Write the contents of a buffer into a disk sector.  Return only
-//	after the data has been written.
+// 	Write the contents of a buffer into a disk sector.  The data only
+//	goes into the cache; the write behind thread gets it to the disk
+//	later, unless the sector is pushed out or the cache is flushed
+//	first.
 //
 //	"sectorNumber" -- the disk sector to be written
 //	"data" -- the new contents of the disk sector
@@ -75,20 +123,701 @@ SynchDisk::ReadSector(int sectorNumber, char* data)
 void
 SynchDisk::WriteSector(int sectorNumber, char* data)
 {
-    lock->Acquire();			// only one disk I/O at a time
-    disk->WriteRequest(sectorNumber, data);
-    semaphore->P();			// wait for interrupt
-    lock->Release();
+    CachedSector *entry;
+
+    cacheLock->Acquire();
+    entry = GetSector(sectorNumber);
+    bcopy(data, entry->data, SectorSize);
+    entry->valid = TRUE;
+    if (!entry->dirty) {
+	entry->dirty = TRUE;
+	Dirtied();
+    }
+    PutSector(entry);
+    cacheLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::ReadSectors
+// 	Read "numSectors" consecutive sectors, from "firstSector" on, into
+//	a buffer.  Return only after the data has been read.
+//
+//	Sectors that are in the cache are read from there, in case they
+//	have been written since they were on the disk; each run of
+//	sectors between them is read from the disk in one request, and
+//	isn't put in the cache.
+//
+//	"firstSector" -- the first disk sector to read
+//	"numSectors" -- how many to read
+//	"data" -- the buffer to hold their contents
+//----------------------------------------------------------------------
+
+void
+SynchDisk::ReadSectors(int firstSector, int numSectors, char* data)
+{
+    int i = 0;
+
+    while (i < numSectors) {
+	int run = 0;
+
+	cacheLock->Acquire();
+	while (i + run < numSectors && !InCache(firstSector + i + run)) {
+	    run++;
+	}
+	cacheLock->Release();
+	if (run == 0) {
+	    ReadSector(firstSector + i, &data[i * SectorSize]);
+	    i++;
+	} else {
+	    (void) Access(firstSector + i, run, &data[i * SectorSize], FALSE);
+	    i += run;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WriteSectors
+// 	Write "numSectors" consecutive sectors, from "firstSector" on,
+//	from a buffer.  Sectors that are in the cache are written there,
+//	as in WriteSector, and so are runs of up to MaxWriteBehind
+//	sectors between them.  Each longer run is written to the disk in
+//	one request, and we wait for it.  Meanwhile, somebody may have
+//	read some of those sectors into the cache, so we bring any copies
+//	there up to date afterwards.
+//
+//	"firstSector" -- the first disk sector to write
+//	"numSectors" -- how many to write
+//	"data" -- their new contents
+//----------------------------------------------------------------------
+
+void
+SynchDisk::WriteSectors(int firstSector, int numSectors, char* data)
+{
+    int i = 0;
+
+    while (i < numSectors) {
+	int run = 0;
+
+	cacheLock->Acquire();
+	while (i + run < numSectors && !InCache(firstSector + i + run)) {
+	    run++;
+	}
+	cacheLock->Release();
+	if (run <= MaxWriteBehind) {
+	    for (run = max(run, 1); run > 0; run--, i++) {
+		WriteSector(firstSector + i, &data[i * SectorSize]);
+	    }
+	} else {
+	    (void) Access(firstSector + i, run, &data[i * SectorSize], TRUE);
+	    Overwritten(firstSector + i, run, &data[i * SectorSize]);
+	    i += run;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Prefetch
+// 	Ask for "sectorNumber" to be read into the cache, but don't wait
+//	for it.  The read ahead thread is started the first time.
+//
+//	"sectorNumber" -- the disk sector that will probably be read soon
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Prefetch(int sectorNumber)
+{
+    cacheLock->Acquire();
+    if (!InCache(sectorNumber) && !prefetches->IsInList(sectorNumber)) {
+	prefetches->Append(sectorNumber);
+	prefetchWanted->Signal(cacheLock);
+    }
+    cacheLock->Release();
+    if (prefetcher == NULL) {
+	prefetcher = new Thread("read ahead", 0);
+	prefetcher->Fork((VoidFunctionPtr) PrefetchThread, (void *) this);
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::IsCached
+// 	Return whether "sectorNumber" is in the cache, or on its way there.
+//----------------------------------------------------------------------
+
+bool
+SynchDisk::IsCached(int sectorNumber)
+{
+    bool result;
+
+    cacheLock->Acquire();
+    result = InCache(sectorNumber);
+    cacheLock->Release();
+    return result;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::PrefetchThread, SynchDisk::Prefetcher
+// 	The read ahead thread.  Take the oldest sector asked for, and any
+//	that were asked for right after it and follow it on disk, up to
+//	MaxPrefetchRun; claim cache entries for them, and read them in
+//	one request.  Anybody who wants one of them meanwhile waits for
+//	it to stop being busy, as if it were a miss of their own.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::PrefetchThread(SynchDisk *synchDisk)
+{
+    synchDisk->Prefetcher();
+}
+
+void
+SynchDisk::Prefetcher()
+{
+    CachedSector *run[MaxPrefetchRun];
+    char buffer[MaxPrefetchRun * SectorSize];
+
+    cacheLock->Acquire();
+    for (;;) {
+	int first, count = 0;
+
+	while (prefetches->IsEmpty()) {
+	    prefetchWanted->Wait(cacheLock);
+	}
+	first = prefetches->RemoveFront();
+	while (count < MaxPrefetchRun) {
+	    CachedSector *entry;
+
+	    if (count > 0) {
+		if (prefetches->IsEmpty()
+			|| prefetches->Front() != first + count) {
+		    break;
+		}
+		(void) prefetches->RemoveFront();
+	    }
+	    entry = GetSector(first + count);	// may wait, so the sector
+	    if (entry->valid) {			// may have come in meanwhile
+		PutSector(entry);
+		break;
+	    }
+	    run[count++] = entry;
+	}
+	if (count == 0) {
+	    continue;
+	}
+	DEBUG(dbgDisk, "Reading ahead " << count << " sectors from " << first);
+	cacheLock->Release();
+	(void) Access(first, count, buffer, FALSE);
+	cacheLock->Acquire();
+	for (int i = 0; i < count; i++) {
+	    bcopy(&buffer[i * SectorSize], run[i]->data, SectorSize);
+	    run[i]->valid = TRUE;
+	    PutSector(run[i]);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Flush
+// 	Write every dirty sector in the cache to the disk, leaving them
+//	in the cache.  Returns once they have all been written.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Flush()
+{
+    WriteBack(TRUE);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Dirtied
+// 	A sector in the cache has just become dirty.  Wake up the write
+//	behind thread now, if there are too many; otherwise make sure it
+//	will be woken up in time.  It is started the first time.
+//	cacheLock must be held.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Dirtied()
+{
+    if (flusher == NULL) {
+	flusher = new Thread("write behind", 0);
+	flusher->Fork((VoidFunctionPtr) FlushThread, (void *) this);
+    }
+    if (++numDirty == DirtyLimit) {
+	flushWanted->V();
+    } else {
+	flushTimer->Set();
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::FlushThread, SynchDisk::Flusher
+// 	The write behind thread.  Each time it is woken up, write back
+//	whatever is dirty and not in use.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::FlushThread(SynchDisk *synchDisk)
+{
+    synchDisk->Flusher();
+}
+
+void
+SynchDisk::Flusher()
+{
+    for (;;) {
+	flushWanted->P();
+	WriteBack(FALSE);
+    }
+}
+
+//----------------------------------------------------------------------
+// BySector
+// 	Compare two cache entries by sector, for sorting.
+//----------------------------------------------------------------------
+
+static int
+BySector(const void *x, const void *y)
+{
+    return (*(CachedSector * const *) x)->sector
+		- (*(CachedSector * const *) y)->sector;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WriteBack
+// 	Write the dirty sectors in the cache to the disk as one batch:
+//	claim them all, then write them in sector order, each run of
+//	consecutive ones as one request, so the head sweeps across the
+//	disk once.  Sectors someone else is using are skipped.
+//
+//	If "all", we don't return until every sector that was dirty when
+//	we started has been written -- by us, or by whoever was using it.
+//	So we wait for the ones we skipped to stop being busy, and do
+//	another batch of whatever is still dirty.  Sectors written after
+//	we started don't count, so a thread that keeps writing can't keep
+//	us here for ever.
+//
+//	We don't hold any entry while waiting for others, so we can't
+//	deadlock with the read ahead thread, which holds a run of them.
+//	Anything still dirty afterwards gets the timer set for it.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::WriteBack(bool all)
+{
+    CachedSector *batch[SectorCacheSize];
+    int pending[SectorCacheSize];	// sectors we still have to see
+    int numPending = 0;			// written, if "all"
+    char *buffer = new char[SectorCacheSize * SectorSize];
+
+    cacheLock->Acquire();
+    for (int i = 0; all && i < SectorCacheSize; i++) {
+	if (cache[i].dirty) {
+	    pending[numPending++] = cache[i].sector;
+	}
+    }
+    for (;;) {
+	int count = 0;
+
+	for (int i = 0; i < SectorCacheSize; i++) {
+	    if (cache[i].dirty && !cache[i].busy) {
+		cache[i].busy = TRUE;
+		batch[count++] = &cache[i];
+	    }
+	}
+	qsort(batch, count, sizeof(CachedSector *), BySector);
+	if (count > 0) {
+	    DEBUG(dbgDisk, "Writing back " << count << " sectors from "
+		    << batch[0]->sector << " to " << batch[count - 1]->sector);
+	}
+
+	for (int i = 0, run; i < count; i += run) {
+	    for (run = 1; i + run < count
+		    && batch[i + run]->sector == batch[i]->sector + run; run++) {
+		;
+	    }
+	    cacheLock->Release();		// they're busy, so nobody
+	    for (int j = 0; j < run; j++) {	// else will touch them
+		bcopy(batch[i + j]->data, &buffer[j * SectorSize], SectorSize);
+	    }
+	    (void) Access(batch[i]->sector, run, buffer, TRUE);
+	    cacheLock->Acquire();
+	    for (int j = 0; j < run; j++) {
+		batch[i + j]->dirty = FALSE;
+		numDirty--;
+		PutSector(batch[i + j]);
+	    }
+	}
+
+	// which of the sectors dirty at the start are dirty still, and
+	// weren't in this batch?  Those are busy, so wait for them.
+	for (int i = 0; i < numPending; ) {
+	    CachedSector *entry = FindSector(pending[i]);
+	    bool written = (entry == NULL || !entry->dirty);
+
+	    for (int j = 0; j < count && !written; j++) {
+		written = (batch[j]->sector == pending[i]);
+	    }
+	    if (written) {
+		pending[i] = pending[--numPending];
+	    } else {
+		i++;
+	    }
+	}
+	if (numPending == 0) {
+	    break;
+	}
+	if (count == 0) {
+	    cacheReady->Wait(cacheLock);
+	}
+    }
+    delete [] buffer;
+    if (numDirty > 0) {
+	flushTimer->Set();
+    }
+    cacheLock->Release();
+}
+
+//----------------------------------------------------------------------
+// FlushTimer::Set
+// 	Arrange for the write behind thread to be woken up FlushDelay
+//	ticks from now, unless it already will be.
+//----------------------------------------------------------------------
+
+void
+FlushTimer::Set()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    if (!pending) {
+	pending = TRUE;
+	kernel->interrupt->Schedule(this, FlushDelay, TimerInt);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// FlushTimer::CallBack
+// 	The timer has gone off: wake up the write behind thread.
+//----------------------------------------------------------------------
+
+void
+FlushTimer::CallBack()
+{
+    pending = FALSE;
+    wake->V();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::GetSector
+// 	Return the cache entry for "sectorNumber", marked busy.  If the
+//	sector isn't in the cache, take the least recently used entry that
+//	isn't busy for it; the entry comes back not valid, for the caller
+//	to fill in.  If that entry is dirty, it is written back first.
+//
+//	We may have to wait: for the sector, if somebody else is using it;
+//	for an entry, if they are all busy; or for the write back.  Each
+//	time, the cache may have changed meanwhile, so we start over.
+//----------------------------------------------------------------------
+
+CachedSector *
+SynchDisk::GetSector(int sectorNumber)
+{
+    for (;;) {
+	CachedSector *entry = NULL, *victim = NULL;
+
+	for (int i = 0; i < SectorCacheSize; i++) {
+	    if (cache[i].sector == sectorNumber) {
+		entry = &cache[i];
+		break;
+	    }
+	    if (!cache[i].busy
+		    && (victim == NULL || cache[i].lastUsed < victim->lastUsed)) {
+		victim = &cache[i];
+	    }
+	}
+	if (entry != NULL) {
+	    if (entry->busy) {
+		cacheReady->Wait(cacheLock);
+		continue;
+	    }
+	    kernel->stats->numDiskCacheHits++;
+	    entry->busy = TRUE;
+	    entry->lastUsed = ++useCount;
+	    return entry;
+	}
+	if (victim == NULL) {		// all busy
+	    cacheReady->Wait(cacheLock);
+	    continue;
+	}
+	if (victim->dirty) {
+	    victim->busy = TRUE;
+	    cacheLock->Release();
+	    DiskWrite(victim->sector, victim->data);
+	    cacheLock->Acquire();
+	    victim->dirty = FALSE;
+	    numDirty--;
+	    PutSector(victim);
+	    continue;
+	}
+	kernel->stats->numDiskCacheMisses++;
+	victim->sector = sectorNumber;
+	victim->valid = FALSE;
+	victim->busy = TRUE;
+	victim->lastUsed = ++useCount;
+	return victim;
+    }
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::InCache
+// 	Return whether the cache has an entry for "sectorNumber" -- even
+//	one that is busy, being read in.  cacheLock must be held.
+//----------------------------------------------------------------------
+
+bool
+SynchDisk::InCache(int sectorNumber)
+{
+    return FindSector(sectorNumber) != NULL;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::FindSector
+// 	Return the cache entry for "sectorNumber", busy or not; NULL if
+//	there is none.  cacheLock must be held.
+//----------------------------------------------------------------------
+
+CachedSector *
+SynchDisk::FindSector(int sectorNumber)
+{
+    for (int i = 0; i < SectorCacheSize; i++) {
+	if (cache[i].sector == sectorNumber) {
+	    return &cache[i];
+	}
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Overwritten
+// 	"numSectors" sectors from "firstSector" on have just been written
+//	to the disk from "data", going around the cache.  They weren't in
+//	the cache when we looked, but a reader may have put some there
+//	since, and its read may have been served before our write, so
+//	copy the new contents into any entries for them.
+//
+//	We wait for an entry that is busy, as it may be being read in.
+//	One that is dirty was written after we looked; it is newer than
+//	ours, so it stays.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Overwritten(int firstSector, int numSectors, char* data)
+{
+    cacheLock->Acquire();
+    for (int i = 0; i < numSectors; i++) {
+	CachedSector *entry;
+
+	while ((entry = FindSector(firstSector + i)) != NULL && entry->busy) {
+	    cacheReady->Wait(cacheLock);
+	}
+	if (entry != NULL && !entry->dirty) {
+	    bcopy(&data[i * SectorSize], entry->data, SectorSize);
+	    entry->valid = TRUE;
+	}
+    }
+    cacheLock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::PutSector
+// 	The current thread is done with cache entry "entry": let anybody
+//	waiting for it have it.  cacheLock must be held.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::PutSector(CachedSector *entry)
+{
+    entry->busy = FALSE;
+    cacheReady->Broadcast(cacheLock);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::DiskRead, SynchDisk::DiskWrite
+// 	Read or write a sector on the disk itself, and wait until it is
+//	done.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::DiskRead(int sectorNumber, char* data)
+{
+    (void) Access(sectorNumber, 1, data, FALSE);
+}
+
+void
+SynchDisk::DiskWrite(int sectorNumber, char* data)
+{
+    (void) Access(sectorNumber, 1, data, TRUE);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Access
+// 	Ask the disk to read or write "count" sectors from "sectorNumber"
+//	on, now if it is idle, or else once the policy picks us from the
+//	queue.  Wait until it is done, and return how long that took, in
+//	ticks.
+//----------------------------------------------------------------------
+
+int
+SynchDisk::Access(int sectorNumber, int count, char* data, bool writing)
+{
+    DiskRequest request;
+    int start = kernel->stats->totalTicks;
+    IntStatus oldLevel;
+
+    ASSERT(count > 0 && sectorNumber + count <= NumSectors);
+    request.sector = sectorNumber;
+    request.count = count;
+    request.data = data;
+    request.writing = writing;
+    request.done = new Semaphore("disk request", 0);
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    if (active == NULL) {
+	Start(&request);
+    } else {
+	queue->Append(&request);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+
+    request.done->P();			// wait for interrupt
+    delete request.done;
+    return kernel->stats->totalTicks - start;
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Start
+// 	Give the next sector of "request" to the disk, which must be
+//	idle.  Interrupts are disabled.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::Start(DiskRequest *request)
+{
+    ASSERT(active == NULL);
+    active = request;
+    head = request->sector;
+    if (request->writing) {
+	disk->WriteRequest(request->sector, request->data);
+    } else {
+	disk->ReadRequest(request->sector, request->data);
+    }
 }
 
 //----------------------------------------------------------------------
 // SynchDisk::CallBack
-// 	Disk interrupt handler.  Wake up any thread waiting for the disk
-//	request to finish.
+// 	Disk interrupt handler.  If the request has more sectors to go,
+//	start on the next one right away, while the head is over it.
+//	Otherwise wake up the thread waiting for the disk request to
+//	finish, and start the next request, if any are waiting.
 //----------------------------------------------------------------------
 
 void
 SynchDisk::CallBack()
 { 
-    semaphore->V();
+    DiskRequest *done = active;
+
+    active = NULL;
+    if (--done->count > 0) {
+	done->sector++;
+	done->data += SectorSize;
+	Start(done);
+	return;
+    }
+    if (!queue->IsEmpty()) {		// keep the disk busy
+	Start(policy->RemoveNext(queue, head, disk));
+    }
+    done->done->V();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::Benchmark
+// 	Measure how long disk requests take under each scheduling policy,
+//	in ticks, from when they are asked for to when they are done.
+//	DiskBenchThreads threads each read DiskBenchRequests random
+//	sectors, one after another, so up to DiskBenchThreads requests
+//	wait for the disk at once.  Every policy gets the same sectors.
+//
+//	The disk must be idle, and stays in use by this policy afterwards.
+//----------------------------------------------------------------------
+
+static const int DiskBenchThreads = 8;
+static const int DiskBenchRequests = 32;
+static const int DiskBenchTotal = DiskBenchThreads * DiskBenchRequests;
+
+static int benchSector[DiskBenchTotal];		// what each request reads
+static int benchLatency[DiskBenchTotal];	// and how long it took
+static Semaphore *benchDone;			// V'd as each thread finishes
+static int benchThread[DiskBenchThreads];	// each thread's number, to
+						// pass it a pointer to
+
+static int
+CompareInts(const void *x, const void *y)
+{
+    return *(const int *) x - *(const int *) y;
+}
+
+void
+SynchDisk::BenchmarkThread(int *which)
+{
+    char buffer[SectorSize];
+
+    for (int i = *which * DiskBenchRequests;
+		i < (*which + 1) * DiskBenchRequests; i++) {
+	benchLatency[i] = kernel->synchDisk->Access(benchSector[i], 1,
+							buffer, FALSE);
+    }
+    benchDone->V();
+}
+
+void
+SynchDisk::Benchmark()
+{
+    static const DiskPolicyType types[] =
+		{ FCFSDisk, SSTFDisk, SCANDisk, CLOOKDisk };
+    DiskPolicy *saved = policy;
+
+    ASSERT(this == kernel->synchDisk);
+    for (int i = 0; i < DiskBenchTotal; i++) {
+	benchSector[i] = RandomNumber() % NumSectors;
+    }
+    benchDone = new Semaphore("disk benchmark", 0);
+
+    cout << "Disk scheduling benchmark: " << DiskBenchThreads
+	 << " threads, " << DiskBenchRequests
+	 << " random reads each, latency in ticks\n";
+    cout << "policy\tmean\tp99\n";
+    for (unsigned int t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+	double total = 0;
+
+	policy = DiskPolicy::Create(types[t]);
+	for (int i = 0; i < DiskBenchThreads; i++) {
+	    Thread *thread = new Thread("disk benchmark", i);
+
+	    benchThread[i] = i;
+	    thread->Fork((VoidFunctionPtr) BenchmarkThread,
+			 (void *) &benchThread[i]);
+	}
+	for (int i = 0; i < DiskBenchThreads; i++) {
+	    benchDone->P();
+	}
+	qsort(benchLatency, DiskBenchTotal, sizeof(int), CompareInts);
+	for (int i = 0; i < DiskBenchTotal; i++) {
+	    total += benchLatency[i];
+	}
+	cout << policy->getName() << "\t" << total / DiskBenchTotal << "\t"
+	     << benchLatency[(DiskBenchTotal * 99 + 99) / 100 - 1] << "\n";
+	delete policy;
+    }
+    policy = saved;
+    delete benchDone;
 }
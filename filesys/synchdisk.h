@@ -14,6 +14,7 @@
 #include "disk.h"
 #include "synch.h"
 #include "callback.h"
+#include "diskpolicy.h"
 
 // The following class defines a "synchronous" disk abstraction.
 // As with other I/O devices, the raw physical disk is an asynchronous device --
@@ -25,10 +26,72 @@
 // This class provides the abstraction that for any individual thread
 // making a request, it waits around until the operation finishes before
 // returning.
+//
+// Many threads can be waiting for the disk at once.  Their requests
+// are queued, and each time the disk finishes one, a disk scheduling
+// policy picks which to do next (see diskpolicy.h).
+//
+// Recently used sectors are kept in a cache, so reading one again
+// doesn't have to wait for the disk at all.  Writes only go to the
+// cache; a write behind thread writes dirty sectors to the disk, in
+// sector order, once they have waited FlushDelay ticks, or as soon as
+// DirtyLimit of them pile up.  A dirty sector also gets written when
+// it is pushed out of the cache to make room for another, least
+// recently used first, or when the cache is flushed.
+//
+// Reading or writing many consecutive sectors at once is quicker than
+// one at a time: the disk goes straight on from one to the next, as it
+// passes under the head.  Such ranges go around the cache, apart from
+// the sectors already in it, so one big transfer doesn't push out
+// everything else; only short runs of writes are left in the cache
+// for the write behind thread.
+//
+// A reader that is going through a file in order can ask for sectors
+// it will want soon to be read into the cache ahead of time.  A kernel
+// thread reads them, so the reader gets on with what it has meanwhile.
+
+const int SectorCacheSize = 32;		// sectors kept in memory
+const int MaxPrefetchRun = 8;		// sectors read ahead in one request
+const int MaxWriteBehind = 8;		// longer runs of writes go straight
+					// to the disk
+const int DirtyLimit = SectorCacheSize / 2;
+					// dirty sectors before the write
+					// behind thread is woken up early
+const int FlushDelay = 20000;		// ticks a dirty sector may wait for it
+
+// A sector in the cache.  While it is busy, one thread is using it
+// (perhaps waiting for the disk), and everybody else waits.
+
+class CachedSector {
+  public:
+    int sector;				// which one; -1 if none
+    bool valid;				// has it been read (or written)?
+    bool dirty;				// written since it was last on disk
+    bool busy;				// in use by some thread
+    int lastUsed;			// when it was last asked for
+    char data[SectorSize];
+};
+
+// Wakes up the write behind thread FlushDelay ticks after it is set.
+// It is an interrupt handler, so it uses a semaphore.
+
+class FlushTimer : public CallBackObj {
+  public:
+    FlushTimer(Semaphore *toWake) { wake = toWake; pending = FALSE; }
+
+    void Set();				// go off in FlushDelay ticks, unless
+					// already due to
+    void CallBack();			// called when it goes off
+
+  private:
+    Semaphore *wake;
+    bool pending;			// has it been set?
+};
 
 class SynchDisk : public CallBackObj {
   public:
-    SynchDisk();    		        // Initialize a synchronous disk,
+    SynchDisk(DiskPolicyType type = FCFSDisk);
+					// Initialize a synchronous disk,
 					// by initializing the raw Disk.
     ~SynchDisk();			// De-allocate the synch disk data
     
@@ -39,17 +102,79 @@ class SynchDisk : public CallBackObj {
     					// Disk::ReadRequest/WriteRequest and
 					// then wait until the request is done.
     void WriteSector(int sectorNumber, char* data);
+
+    void ReadSectors(int firstSector, int numSectors, char* data);
+    void WriteSectors(int firstSector, int numSectors, char* data);
+					// The same, for "numSectors"
+					// consecutive sectors, as one
+					// request to the disk
     
+    void Prefetch(int sectorNumber);	// start reading a sector into
+					// the cache, without waiting for it
+    bool IsCached(int sectorNumber);	// would reading it hit in the cache?
+
+    void Flush();			// write every dirty cached sector
+					// to the disk, and wait
+
     void CallBack();			// Called by the disk device interrupt
 					// handler, to signal that the
 					// current disk operation is complete.
 
+    void Benchmark();			// time requests under each policy
+
   private:
     Disk *disk;		  		// Raw disk device
-    Semaphore *semaphore; 		// To synchronize requesting thread 
-					// with the interrupt handler
-    Lock *lock;		  		// Only one read/write request
-					// can be sent to the disk at a time
+    DiskPolicy *policy;			// picks the next request
+    List<DiskRequest *> *queue;		// requests waiting for the disk,
+					// in the order they came
+    DiskRequest *active;		// the one it is doing; NULL if idle
+    int head;				// sector of the last request
+
+    CachedSector cache[SectorCacheSize];
+    Lock *cacheLock;			// protects the cache
+    Condition *cacheReady;		// signalled when a cached sector
+					// stops being busy
+    int useCount;			// requests so far, for LRU
+
+    List<int> *prefetches;		// sectors to read ahead, in the
+					// order they were asked for
+    Condition *prefetchWanted;		// signalled when one is added
+    Thread *prefetcher;			// reads them; NULL until the first
+
+    int numDirty;			// dirty sectors in the cache
+    Semaphore *flushWanted;		// V'd to wake up the write behind
+					// thread
+    FlushTimer *flushTimer;
+    Thread *flusher;			// writes them; NULL until the first
+
+    CachedSector *GetSector(int sectorNumber);
+					// find "sectorNumber" in the cache,
+					// or make room for it, and mark it
+					// busy; cacheLock must be held
+    void PutSector(CachedSector *entry);	// done with it
+    void DiskRead(int sectorNumber, char* data);
+    void DiskWrite(int sectorNumber, char* data);
+					// wait for the disk itself
+    int Access(int sectorNumber, int count, char* data, bool writing);
+					// ... for "count" sectors, and
+					// return how long it took
+    bool InCache(int sectorNumber);	// is there a cache entry for it?
+					// cacheLock must be held
+    CachedSector *FindSector(int sectorNumber);
+					// ... and which one?
+    void Overwritten(int firstSector, int numSectors, char* data);
+					// bring the cache up to date with
+					// sectors written around it
+    void Start(DiskRequest *request);	// hand a request to the disk
+    void Prefetcher();			// body of the read ahead thread
+    void Flusher();			// ... and the write behind thread
+    void WriteBack(bool all);		// write dirty sectors to the disk
+    void Dirtied();			// a sector has just become dirty
+
+    static void PrefetchThread(SynchDisk *synchDisk);
+    static void FlushThread(SynchDisk *synchDisk);
+
+    static void BenchmarkThread(int *which);
 };
 
 #endif // SYNCHDISK_H
@@ -0,0 +1,380 @@
+// heap.cc
+//     	Routines to manage a binary heap of "things".
+//	Heaps are implemented as templates so that we can store
+//	anything on the heap in a type-safe manner.
+//
+//	The heap is kept in an array, which is doubled in size whenever
+//	it fills up; so unlike a list, nothing is allocated on each
+//	insert.  To keep the order of items with equal keys the same as
+//	in a SortedList, every item is stamped with an insertion counter,
+//	which is used to break ties.
+//
+//     	NOTE: Mutual exclusion must be provided by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+
+const int HeapInitialSize = 16;		// slots allocated up front
+
+//----------------------------------------------------------------------
+// Heap<T>::Heap
+//	Initialize a heap, empty to start with.
+//	Elements can now be added to the heap.
+//
+//	"comp" is the function used to order items.
+//	"idx" returns a pointer to a field in each item where the heap
+//		can record the item's position, or is NULL.
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::Heap(int (*comp)(T x, T y), int *(*idx)(T x))
+{
+    compare = comp;
+    index = idx;
+    size = HeapInitialSize;
+    heap = new HeapElement<T>[size];
+    numInHeap = 0;
+    numInserted = 0;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::~Heap
+//	Prepare a heap for deallocation.
+//      This does *NOT* free the data the heap points to.
+//----------------------------------------------------------------------
+
+template <class T>
+Heap<T>::~Heap()
+{
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Less
+//	Return TRUE if the item in slot i should come off the heap before
+//	the one in slot j.  Equal keys come off in insertion order.
+//----------------------------------------------------------------------
+
+template <class T>
+bool
+Heap<T>::Less(int i, int j) const
+{
+    int result = compare(heap[i].item, heap[j].item);
+
+    if (result != 0) {
+	return (result < 0);
+    }
+    return ((int) (heap[i].order - heap[j].order) < 0);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Place
+//	Put an element into slot i, and tell the item where it now is.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Place(int i, HeapElement<T> element)
+{
+    heap[i] = element;
+    if (index != NULL) {
+	*index(element.item) = i;
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Find
+//	Return the slot holding "item", or -1 if it isn't on the heap.
+//	If the items record their own position, this is O(1); otherwise
+//	we have to search.
+//----------------------------------------------------------------------
+
+template <class T>
+int
+Heap<T>::Find(T item) const
+{
+    int i;
+
+    if (index != NULL) {
+	i = *index(item);
+	if (i >= 0 && i < numInHeap && heap[i].item == item) {
+	    return i;
+	}
+	return -1;
+    }
+    for (i = 0; i < numInHeap; i++) {
+	if (heap[i].item == item) {
+	    return i;
+	}
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftUp
+//	Move the element in slot i towards the root, until its parent
+//	is smaller.  Returns the slot it ends up in.
+//----------------------------------------------------------------------
+
+template <class T>
+int
+Heap<T>::SiftUp(int i)
+{
+    HeapElement<T> element = heap[i];
+    int parent;
+
+    while (i > 0) {
+	parent = (i - 1) / 2;
+	heap[i] = element;		// so Less() can look at it
+	if (!Less(i, parent)) {
+	    break;
+	}
+	Place(i, heap[parent]);
+	i = parent;
+    }
+    Place(i, element);
+    return i;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::SiftDown
+//	Move the element in slot i towards the leaves, until both its
+//	children are larger.  Returns the slot it ends up in.
+//----------------------------------------------------------------------
+
+template <class T>
+int
+Heap<T>::SiftDown(int i)
+{
+    HeapElement<T> element = heap[i];
+    int child;
+
+    for (;;) {
+	child = 2 * i + 1;
+	if (child >= numInHeap) {
+	    break;
+	}
+	if (child + 1 < numInHeap && Less(child + 1, child)) {
+	    child++;			// pick the smaller child
+	}
+	heap[i] = element;		// so Less() can look at it
+	if (!Less(child, i)) {
+	    break;
+	}
+	Place(i, heap[child]);
+	i = child;
+    }
+    Place(i, element);
+    return i;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Insert
+//      Put an item on the heap, growing the array if it is full.
+//
+//	"item" is the thing to put on the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Insert(T item)
+{
+    HeapElement<T> element;
+
+    ASSERT(!IsInHeap(item));
+    if (numInHeap == size) {
+	HeapElement<T> *bigger = new HeapElement<T>[2 * size];
+
+	for (int i = 0; i < numInHeap; i++) {
+	    bigger[i] = heap[i];
+	}
+	delete [] heap;
+	heap = bigger;
+	size *= 2;
+    }
+    element.item = item;
+    element.order = numInserted++;
+    Place(numInHeap, element);
+    numInHeap++;
+    SiftUp(numInHeap - 1);
+    ASSERT(IsInHeap(item));
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveAt
+//      Take the item in slot i off the heap, by moving the last
+//	element into its place and fixing up the order around it.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::RemoveAt(int i)
+{
+    ASSERT(i >= 0 && i < numInHeap);
+
+    if (index != NULL) {
+	*index(heap[i].item) = -1;
+    }
+    numInHeap--;
+    if (i < numInHeap) {
+	Place(i, heap[numInHeap]);
+	if (SiftUp(i) == i) {
+	    SiftDown(i);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::RemoveFront
+//      Remove the smallest item from the heap.
+//	Returns the removed item.
+//	Heap must not be empty.
+//----------------------------------------------------------------------
+
+template <class T>
+T
+Heap<T>::RemoveFront()
+{
+    T item;
+
+    ASSERT(!IsEmpty());
+    item = heap[0].item;
+    RemoveAt(0);
+    ASSERT(!IsInHeap(item));
+    return item;
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Remove
+//      Remove a specific item from the heap.  Must be on the heap.
+//
+//	"item" is the thing to remove.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Remove(T item)
+{
+    int i = Find(item);
+
+    ASSERT(i >= 0);
+    RemoveAt(i);
+    ASSERT(!IsInHeap(item));
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::DecreaseKey
+//      The caller has changed "item" so that it compares smaller than
+//	before; move it up to its new place.  The item keeps its
+//	original insertion order for breaking ties.
+//
+//	"item" is the thing whose key has changed.  Must be on the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::DecreaseKey(T item)
+{
+    int i = Find(item);
+
+    ASSERT(i >= 0);
+    SiftUp(i);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::IsInHeap
+//      Return TRUE if the item is on the heap.
+//----------------------------------------------------------------------
+
+template <class T>
+bool
+Heap<T>::IsInHeap(T item) const
+{
+    return (Find(item) >= 0);
+}
+
+//----------------------------------------------------------------------
+// Heap<T>::Apply
+//      Apply function to every item on the heap.  The items are
+//	visited in heap order, not sorted order.
+//
+//	"func" -- the function to apply
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::Apply(void (*func)(T)) const
+{
+    for (int i = 0; i < numInHeap; i++) {
+	(*func)(heap[i].item);
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap::SanityCheck
+//      Test whether this is still a legal heap.
+//
+//	Tests: is every item no smaller than its parent?
+//	       does every item know where it is?
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SanityCheck() const
+{
+    ASSERT(numInHeap >= 0 && numInHeap <= size);
+    for (int i = 0; i < numInHeap; i++) {
+	if (i > 0) {
+	    ASSERT(!Less(i, (i - 1) / 2));
+	}
+	if (index != NULL) {
+	    ASSERT(*index(heap[i].item) == i);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// Heap::SelfTest
+//      Test whether this module is working.
+//----------------------------------------------------------------------
+
+template <class T>
+void
+Heap<T>::SelfTest(T *p, int numEntries)
+{
+    int i;
+    T *q = new T[numEntries];
+
+    ASSERT(IsEmpty());
+    for (i = 0; i < numEntries; i++) {
+	Insert(p[i]);
+	ASSERT(IsInHeap(p[i]));
+    }
+    ASSERT(NumInHeap() == (unsigned int) numEntries);
+    SanityCheck();
+
+    // take out the first item from the middle, and put it back
+    Remove(p[0]);
+    ASSERT(!IsInHeap(p[0]));
+    SanityCheck();
+    Insert(p[0]);
+    SanityCheck();
+
+    // should be able to get out everything we put in
+    for (i = 0; i < numEntries; i++) {
+	q[i] = RemoveFront();
+	ASSERT(!IsInHeap(q[i]));
+    }
+    ASSERT(IsEmpty());
+
+    // make sure everything came out in the right order
+    for (i = 0; i < (numEntries - 1); i++) {
+	ASSERT(compare(q[i], q[i + 1]) <= 0);
+    }
+    SanityCheck();
+
+    delete [] q;
+}
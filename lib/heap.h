@@ -0,0 +1,108 @@
+// heap.h
+//	Data structures to manage a priority queue, implemented as an
+//	array-based binary heap.
+//
+//	A heap keeps its items partially sorted, so that the smallest
+//	item can be found in constant time, and items can be inserted
+//	or removed in O(log n) time.  Unlike a SortedList, no memory is
+//	allocated on each insert; the array only grows when it fills up.
+//
+//	Items with equal keys come out in the order they were inserted,
+//	just as with a SortedList.
+//
+//	Allocation and deallocation of the items on the heap are to be
+//	done by the caller.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "copyright.h"
+#include "debug.h"
+
+// The following class defines a "heap element" -- the item, plus
+// the insertion order used to break ties between equal keys.
+//
+// This class is private to this module. Made public for notational
+// convenience.
+
+template <class T>
+class HeapElement {
+  public:
+    T item;			// item on the heap
+    unsigned int order;		// when the item was inserted
+};
+
+// The following class defines a "heap" -- an array of heap elements,
+// arranged so that "RemoveFront" always returns the smallest item.
+// All types to be put on a heap must have a "Compare" function defined:
+//	   int Compare(T x, T y)
+//		returns -1 if x < y
+//		returns 0 if x == y
+//		returns 1 if x > y
+//
+// If the items can record their own position in the heap, an "index"
+// function returning a pointer to that field can also be passed in.
+// Remove, IsInHeap and DecreaseKey then take O(log n) or O(1) time,
+// rather than having to search the heap.
+
+template <class T>
+class Heap {
+  public:
+    Heap(int (*comp)(T x, T y), int *(*index)(T x) = NULL);
+				// initialize the heap
+    ~Heap();			// de-allocate the heap
+
+    void Insert(T item); 	// put an item on the heap
+
+    T Front() { ASSERT(!IsEmpty()); return heap[0].item; }
+    				// Return smallest item on heap
+				// without removing it
+    T RemoveFront(); 		// Take smallest item off the heap
+    void Remove(T item); 	// Remove specific item from heap
+    void DecreaseKey(T item);	// item's key has become smaller;
+				// move it up to its new place
+
+    bool IsInHeap(T item) const;// is the item on the heap?
+
+    unsigned int NumInHeap() { return numInHeap;};
+    				// how many items on the heap?
+    bool IsEmpty() { return (numInHeap == 0); };
+    				// is the heap empty?
+
+    void Apply(void (*f)(T)) const;
+    				// apply function to all items on the
+				// heap, in no particular order
+
+    void SanityCheck() const;	// has this heap been corrupted?
+    void SelfTest(T *p, int numEntries);
+				// verify module is working
+
+  private:
+    HeapElement<T> *heap;	// the heap; children of heap[i] are
+				// heap[2i+1] and heap[2i+2]
+    int numInHeap;		// number of items on the heap
+    int size;			// number of slots allocated
+    unsigned int numInserted;	// insertion counter, to break ties
+
+    int (*compare)(T x, T y);	// function for ordering items
+    int *(*index)(T x);		// where an item remembers its position,
+				// or NULL if it can't
+
+    bool Less(int i, int j) const;
+				// should heap[i] come out before heap[j]?
+    void Place(int i, HeapElement<T> element);
+				// store element into slot i
+    int Find(T item) const;	// position of item, or -1
+    int SiftUp(int i);		// restore order above slot i
+    int SiftDown(int i);	// restore order below slot i
+    void RemoveAt(int i);	// take the item in slot i off the heap
+};
+
+#include "heap.cc"		// templates are really like macros
+				// so needs to be included in every
+				// file that uses the template
+#endif // HEAP_H
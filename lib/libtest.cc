@@ -1,6 +1,7 @@
 // libtest.cc 
 //	Driver code to call self-test routines for standard library
-//	classes -- bitmaps, lists, sorted lists, and hash tables.
+//	classes -- bitmaps, lists, sorted lists, heaps, and hash tables.
+//	Also contains benchmarks comparing some of those classes.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -10,13 +11,14 @@
 #include "libtest.h"
 #include "bitmap.h"
 #include "list.h"
+#include "heap.h"
 #include "hash.h"
 #include "sysdep.h"
 
 //----------------------------------------------------------------------
 // IntCompare
 //	Compare two integers together.  Serves as the comparison
-//	function for testing SortedLists
+//	function for testing SortedLists and Heaps
 //----------------------------------------------------------------------
 
 static int 
@@ -50,7 +52,7 @@ HashKey(char *str) {
     return atoi(str);
 }
 
-// Array of values to be inserted into a List or SortedList. 
+// Array of values to be inserted into a List, SortedList or Heap. 
 static int listTestVector[] = { 9, 5, 7 };
 
 // Array of values to be inserted into the HashTable
@@ -60,7 +62,7 @@ static char *hashTestVector[] = { "0", "1", "2", "3", "4", "5", "6",
 
 //----------------------------------------------------------------------
 // LibSelfTest
-//	Run self tests on bitmaps, lists, sorted lists, and 
+//	Run self tests on bitmaps, lists, sorted lists, heaps, and 
 //	hash tables.
 //----------------------------------------------------------------------
 
@@ -69,6 +71,7 @@ LibSelfTest () {
     Bitmap *map = new Bitmap(200);
     List<int> *list = new List<int>;
     SortedList<int> *sortList = new SortedList<int>(IntCompare);
+    Heap<int> *heap = new Heap<int>(IntCompare);
     HashTable<int, char *> *hashTable = 
 	new HashTable<int, char *>(HashKey, HashInt);
 	
@@ -76,10 +79,144 @@ LibSelfTest () {
     map->SelfTest();
     list->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     sortList->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
+    heap->SelfTest(listTestVector, sizeof(listTestVector)/sizeof(int));
     hashTable->SelfTest(hashTestVector, sizeof(hashTestVector)/sizeof(char *));
 
     delete map;
     delete list;
     delete sortList;
+    delete heap;
     delete hashTable;
 }
+
+//----------------------------------------------------------------------
+// BenchItem
+//	Stand-in for a thread on the ready queue: a key to sort on, and
+//	a slot where a Heap can record the item's position.
+//----------------------------------------------------------------------
+
+struct BenchItem {
+    double key;
+    int heapIndex;
+};
+
+static int
+BenchCompare(BenchItem *x, BenchItem *y)
+{
+    if (x->key < y->key) return -1;
+    else if (x->key == y->key) return 0;
+    else return 1;
+}
+
+static int *
+BenchIndex(BenchItem *x)
+{
+    return &x->heapIndex;
+}
+
+// Number of remove/insert pairs timed for each queue length
+static const int benchRounds = 20000;
+
+//----------------------------------------------------------------------
+// BenchFill, BenchNextKey
+//	Give "n" items random keys, and pick a random new key for an
+//	item that just came off the queue, as if it ran for a while and
+//	got a new burst estimate.  Both queues see the same sequence.
+//----------------------------------------------------------------------
+
+static void
+BenchFill(BenchItem *items, int n)
+{
+    RandomInit(n);
+    for (int i = 0; i < n; i++) {
+	items[i].key = RandomNumber() % 1000;
+	items[i].heapIndex = -1;
+    }
+}
+
+static double
+BenchNextKey(BenchItem *item)
+{
+    return item->key + RandomNumber() % 1000;
+}
+
+//----------------------------------------------------------------------
+// TimeSortedList, TimeHeap
+//	Put "n" items on a queue, then time "benchRounds" rounds of
+//	taking off the smallest and putting it back with a new key --
+//	what FindNextToRun and ReadyToRun do for a busy ready queue.
+//	Returns the time per round, in microseconds.
+//----------------------------------------------------------------------
+
+static double
+TimeSortedList(BenchItem *items, int n)
+{
+    SortedList<BenchItem *> *queue = new SortedList<BenchItem *>(BenchCompare);
+    BenchItem *item;
+    double start;
+    int i;
+
+    BenchFill(items, n);
+    for (i = 0; i < n; i++) {
+	queue->Insert(&items[i]);
+    }
+    start = HostTime();
+    for (i = 0; i < benchRounds; i++) {
+	item = queue->RemoveFront();
+	item->key = BenchNextKey(item);
+	queue->Insert(item);
+    }
+    start = HostTime() - start;
+    while (!queue->IsEmpty()) {
+	queue->RemoveFront();
+    }
+    delete queue;
+    return start * 1000000.0 / benchRounds;
+}
+
+static double
+TimeHeap(BenchItem *items, int n)
+{
+    Heap<BenchItem *> *queue = new Heap<BenchItem *>(BenchCompare, BenchIndex);
+    BenchItem *item;
+    double start;
+    int i;
+
+    BenchFill(items, n);
+    for (i = 0; i < n; i++) {
+	queue->Insert(&items[i]);
+    }
+    start = HostTime();
+    for (i = 0; i < benchRounds; i++) {
+	item = queue->RemoveFront();
+	item->key = BenchNextKey(item);
+	queue->Insert(item);
+    }
+    start = HostTime() - start;
+    queue->SanityCheck();
+    delete queue;
+    return start * 1000000.0 / benchRounds;
+}
+
+//----------------------------------------------------------------------
+// LibBenchmark
+//	Compare a SortedList against a Heap as a ready queue, as the
+//	number of ready threads grows.
+//----------------------------------------------------------------------
+
+void
+LibBenchmark() {
+    const int maxItems = 4096;
+    BenchItem *items = new BenchItem[maxItems];
+
+    cout << "Ready queue benchmark: " << benchRounds 
+	 << " remove/insert rounds, microseconds per round\n";
+    cout << "threads\tSortedList\tHeap\n";
+    for (int n = 4; n <= maxItems; n *= 4) {
+	double listTime = TimeSortedList(items, n);
+	double heapTime = TimeHeap(items, n);
+
+	cout << n << "\t" << listTime << "\t\t" << heapTime << "\n";
+    }
+    delete [] items;
+}
@@ -194,6 +194,21 @@ RandomNumber()
     return rand();
 }
 
+//----------------------------------------------------------------------
+// HostTime
+// 	Return the time of day on the host, in seconds.  Only differences
+//	between two calls are meaningful; used to time benchmarks.
+//----------------------------------------------------------------------
+
+double
+HostTime()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
 //----------------------------------------------------------------------
 // AllocBoundedArray
 // 	Return an array, with the two pages just before 
@@ -410,6 +425,19 @@ Close(int fd)
     return retVal;
 }
 
+//----------------------------------------------------------------------
+// Dup
+// 	Make another file descriptor for an open file.  Abort on error.
+//----------------------------------------------------------------------
+
+int 
+Dup(int fd)
+{
+    int newFd = dup(fd);
+    ASSERT(newFd >= 0);
+    return newFd;
+}
+
 //----------------------------------------------------------------------
 // Unlink
 // 	Delete a file.
@@ -32,6 +32,9 @@ extern void CallOnUserAbort(void (*cleanup)(int));
 extern void RandomInit(unsigned seed);
 extern unsigned int RandomNumber();
 
+// Host wall-clock time in seconds, for timing benchmarks
+extern double HostTime();
+
 // Allocate, de-allocate an array, such that de-referencing
 // just beyond either end of the array will cause an error
 extern char *AllocBoundedArray(int size);
@@ -51,6 +54,7 @@ extern void WriteFile(int fd, char *buffer, int nBytes);
 extern void Lseek(int fd, int offset, int whence);
 extern int Tell(int fd);
 extern int Close(int fd);
+extern int Dup(int fd);
 extern bool Unlink(char *name);
 
 // Other C library routines that are used by Nachos.
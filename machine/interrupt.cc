@@ -22,6 +22,7 @@
 
 #include "copyright.h"
 #include "interrupt.h"
+#include "timingwheel.h"
 #include "main.h"
 
 // String definitions for debugging messages
@@ -47,19 +48,8 @@ PendingInterrupt::PendingInterrupt(CallBackObj *callOnInt,
     callOnInterrupt = callOnInt;
     when = time;
     type = kind;
-}
-
-//----------------------------------------------------------------------
-// PendingCompare
-//	Compare to interrupts based on which should occur first.
-//----------------------------------------------------------------------
-
-static int
-PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
-{
-    if (x->when < y->when) { return -1; }
-    else if (x->when > y->when) { return 1; }
-    else { return 0; }
+    seq = 0;
+    next = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -72,7 +62,8 @@ PendingCompare (PendingInterrupt *x, PendingInterrupt *y)
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new SortedList<PendingInterrupt *>(PendingCompare);
+    pending = new TimingWheel();
+    nextDue = NeverDue;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -85,9 +76,6 @@ Interrupt::Interrupt()
 
 Interrupt::~Interrupt()
 {
-    while (!pending->IsEmpty()) {
-	delete pending->RemoveFront();
-    }
     delete pending;
 }
 
@@ -239,6 +227,7 @@ Interrupt::Halt()
     cout << "Machine halting!\n\n";
     cout << "This is halt\n";
     kernel->stats->Print();
+    kernel->scheduler->PrintPredictions();
     delete kernel;	// Never returns.
 }
 /*
@@ -284,7 +273,8 @@ Interrupt::CloseFile(OpenFileId id)
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: put it on a timing wheel, and remember
+//	when the first interrupt on it is due.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -298,12 +288,13 @@ void
 Interrupt::Schedule(CallBackObj *toCall, int fromNow, IntType type)
 {
     int when = kernel->stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(toCall, when, type);
+    PendingInterrupt *toOccur = pending->Allocate(toCall, when, type);
 
     DEBUG(dbgInt, "Scheduling interrupt handler the " << intTypeNames[type] << " at time = " << when);
     ASSERT(fromNow > 0);
 
     pending->Insert(toOccur);
+    nextDue = pending->NextDue();
 }
 
 //----------------------------------------------------------------------
@@ -332,18 +323,18 @@ Interrupt::CheckIfDue(bool advanceClock)
     if (pending->IsEmpty()) {   	// no pending interrupts
 	return FALSE;	
     }		
-    next = pending->Front();
 
-    if (next->when > stats->totalTicks) {
+    if (pending->NextDue() > stats->totalTicks) {
         if (!advanceClock) {		// not time yet
             return FALSE;
         }
         else {      		// advance the clock to next interrupt
-	    stats->idleTicks += (next->when - stats->totalTicks);
-	    stats->totalTicks = next->when;
+	    stats->idleTicks += (pending->NextDue() - stats->totalTicks);
+	    stats->totalTicks = pending->NextDue();
 	    // UDelay(1000L); // rcgood - to stop nachos from spinning.
 	}
     }
+    next = pending->Front();	// only now that it is due
 
     DEBUG(dbgInt, "Invoking interrupt handler for the ");
     DEBUG(dbgInt, intTypeNames[next->type] << " at time " << next->when);
@@ -358,9 +349,10 @@ Interrupt::CheckIfDue(bool advanceClock)
 		DEBUG(dbgTraCode, "In Interrupt::CheckIfDue, into callOnInterrupt->CallBack, " << stats->totalTicks);
         next->callOnInterrupt->CallBack();// call the interrupt handler
 		DEBUG(dbgTraCode, "In Interrupt::CheckIfDue, return from callOnInterrupt->CallBack, " << stats->totalTicks);
-	delete next;
+	pending->Free(next);
     } while (!pending->IsEmpty() 
-    		&& (pending->Front()->when <= stats->totalTicks));
+    		&& (pending->NextDue() <= stats->totalTicks));
+    nextDue = pending->NextDue();
     inHandler = FALSE;
     return TRUE;
 }
@@ -51,6 +51,9 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
 			NetworkSendInt, NetworkRecvInt};
 
+// Value of Interrupt::getNextDue() when no interrupt is pending.
+const int NeverDue = 0x7fffffff;
+
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
 // left public to make it simpler to manipulate.
@@ -68,8 +71,14 @@ class PendingInterrupt {
     
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+
+    unsigned int seq;		// order in which interrupts were scheduled,
+				// to break ties between equal "when"s
+    PendingInterrupt *next;	// next on the same timing wheel slot
 };
 
+class TimingWheel;
+
 // The following class defines the data structures for the simulation
 // of hardware interrupts.  We record whether interrupts are enabled
 // or disabled, and any hardware interrupts that are scheduled to occur
@@ -125,12 +134,17 @@ class Interrupt {
     				// by the hardware device simulators.
     
     void OneTick();       	// Advance simulated time
+    int getNextDue() { return nextDue; }
+				// Time the first pending interrupt
+				// is due, or NeverDue if there is none.
+				// Until then, OneTick only has to
+				// advance the clock.
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    SortedList<PendingInterrupt *> *pending;		
-    				// the list of interrupts scheduled
+    TimingWheel *pending;	// the interrupts scheduled
 				// to occur in the future
+    int nextDue;		// cached "when" of the front of "pending"
     //int writeFileNo;            //UNIX file emulating the display
     bool inHandler;		// TRUE if we are running an interrupt handler
     //bool putBusy;               // Is a PrintInt operation in progress
@@ -61,15 +61,21 @@ Machine::Machine(bool debug)
     mainMemory = new char[MemorySize];
     for (i = 0; i < MemorySize; i++)
       	mainMemory[i] = 0;
-#ifdef USE_TLB
-    tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++)
-	tlb[i].valid = FALSE;
-    pageTable = NULL;
-#else	// use linear page table
+    decodeCache = new Instruction[MemorySize / 4];
+    for (i = 0; i < MemorySize / 4; i++)
+	decodeCache[i].opCode = 0;	// nothing decoded yet
+    for (i = 0; i < NumPhysPages; i++)
+	hasCode[i] = FALSE;
+    uncountedTicks = 0;
+    FlushTranslations();
     tlb = NULL;
+    tlbSize = 0;
+    tlbNextVictim = NULL;
+    currentASID = 0;
     pageTable = NULL;
-#endif
+#ifdef USE_TLB
+    UseTLB(TLBSize, TLBSize);
+#endif	// otherwise, use linear page table
 
     singleStep = debug;
     CheckEndian();
@@ -83,8 +89,29 @@ Machine::Machine(bool debug)
 Machine::~Machine()
 {
     delete [] mainMemory;
-    if (tlb != NULL)
+    delete [] decodeCache;
+    if (tlb != NULL) {
         delete [] tlb;
+	delete [] tlbNextVictim;
+    }
+}
+
+//----------------------------------------------------------------------
+// Machine::InvalidateCode
+// 	The contents of physical page "frame" have changed, so throw away
+//	any instructions we decoded from it.
+//----------------------------------------------------------------------
+
+void
+Machine::InvalidateCode(int frame)
+{
+    if (!hasCode[frame]) {
+	return;
+    }
+    for (int i = frame * PageSize / 4; i < (frame + 1) * PageSize / 4; i++) {
+	decodeCache[i].opCode = 0;
+    }
+    hasCode[frame] = FALSE;
 }
 
 //----------------------------------------------------------------------
@@ -101,6 +128,7 @@ void
 Machine::RaiseException(ExceptionType which, int badVAddr)
 {
     DEBUG(dbgMach, "Exception: " << exceptionNames[which]);
+    CountTicks();			// the kernel sees the current time
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
     kernel->interrupt->setStatus(SystemMode);
@@ -39,6 +39,10 @@ const int NumPhysPages = 128;
 
 const int MemorySize = (NumPhysPages * PageSize);
 const int TLBSize = 4;			// if there is a TLB, make it small
+const int NumASIDs = 64;		// address space IDs a TLB entry
+					// can be tagged with
+const int TranslationCacheSize = 64;	// recent translations ReadMem and
+					// WriteMem remember; a power of 2
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -77,6 +81,28 @@ enum ExceptionType { NoException,           // Everything ok!
 
 #define NumTotalRegs 	40
 
+// The following class defines an instruction, represented in both
+// 	undecoded binary form
+//      decoded to identify
+//	    operation to do
+//	    registers to act on
+//	    any immediate operand value
+
+class Instruction {
+  public:
+    void Decode();	// decode the binary representation of the instruction
+
+    unsigned int value; // binary representation of the instruction
+
+    char opCode;     // Type of instruction.  This is NOT the same as the
+    		     // opcode field from the instruction: see defs in mips.h
+		     // Decode never sets it to 0, so that can mean "not
+		     // decoded yet".
+    char rs, rt, rd; // Three registers from instruction.
+    int extra;       // Immediate or target or shamt field or offset.
+                     // Immediates are sign-extended.
+};
+
 // The following class defines the simulated host workstation hardware, as 
 // seen by user programs -- the CPU registers, main memory, etc.
 // User programs shouldn't be able to tell that they are running on our 
@@ -90,8 +116,8 @@ enum ExceptionType { NoException,           // Everything ok!
 // The procedures in this class are defined in machine.cc, mipssim.cc, and
 // translate.cc.
 
-class Instruction;
 class Interrupt;
+class PageTable;
 
 class Machine {
   public:
@@ -136,23 +162,55 @@ class Machine {
 
     TranslationEntry *tlb;		// this pointer should be considered 
 					// "read-only" to Nachos kernel code
+    int tlbSize;			// entries in the TLB (read-only)
 
-    TranslationEntry *pageTable;
-    unsigned int pageTableSize;
+    PageTable *pageTable;		// the current address space's
 
     bool ReadMem(int addr, int size, int* value);
     bool WriteMem(int addr, int size, int value);
     				// Read or write 1, 2, or 4 bytes of virtual 
 				// memory (at addr).  Return FALSE if a 
 				// correct translation couldn't be found.
+
+    void InvalidateCode(int frame);
+				// Forget the decoded instructions in a
+				// physical page, because its contents
+				// changed.  WriteMem does this itself; the
+				// kernel has to when it writes "mainMemory"
+				// directly, or gives the frame to someone else.
+
+    void UseTLB(int size, int ways);
+				// Translate through a TLB of "size"
+				// entries, "ways"-way set associative,
+				// instead of a page table
+    void SetASID(int id);	// Use the TLB entries tagged "id" (the
+				// address space about to run)
+    bool WriteTLB(TranslationEntry *entry, TranslationEntry *evicted);
+				// Load "entry" into the TLB, tagged with
+				// the current address space; return TRUE
+				// if that replaced a valid entry, and
+				// copy that to "evicted"
+
+    void FlushTranslations();	// Forget the translations ReadMem and
+				// WriteMem have cached.  The kernel has to
+				// call this whenever it changes the page
+				// table or TLB, or clears a use or dirty bit.
   private:
 
 // Routines internal to the machine simulation -- DO NOT call these directly
     void DelayedLoad(int nextReg, int nextVal);  	
 				// Do a pending delayed load (modifying a reg)
 
-    void OneInstruction(Instruction *instr); 	
-    				// Run one instruction of a user program.
+    void RunBlock(int limit);	// Run a block of instructions of a user
+				// program, at most "limit" of them.
+    Instruction *FetchInstruction(int addr, int *physAddr);
+				// Translate and decode the instruction at
+				// "addr"
+    Instruction *Decoded(int physAddr);
+				// The instruction at "physAddr", from the
+				// decode cache if we can
+    void CountTicks();		// Charge the time for the instructions run
+				// so far in this block
     
 
 
@@ -175,6 +233,31 @@ class Machine {
 
     int registers[NumTotalRegs]; // CPU registers, for executing user programs
 
+    Instruction *decodeCache;	// every word of physical memory that has
+				// been run as an instruction, decoded
+    bool hasCode[NumPhysPages];	// TRUE if a page has decoded instructions
+				// in "decodeCache"
+    int uncountedTicks;		// time for instructions RunBlock has run,
+				// but not yet added to the statistics
+
+    struct CachedTranslation {
+	int readPage;		// virtual page this maps, if ReadMem may
+				// use it, or -1
+	int writePage;		// the same, if WriteMem may use it, or -1
+	char *page;		// where the page is in "mainMemory"
+    };
+    CachedTranslation translations[TranslationCacheSize];
+				// recent translations by ReadMem and
+				// WriteMem, direct-mapped by virtual page
+    char *CacheTranslation(int virtAddr, int physAddr, bool writing);
+				// remember the translation Translate just
+				// made for them
+
+    int tlbWays;		// entries in each set of the TLB
+    int tlbSets;		// tlbSize / tlbWays
+    int *tlbNextVictim;		// for each set, the way to replace next
+    int currentASID;		// tag of the TLB entries in use
+
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
@@ -24,26 +24,6 @@
 
 static void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
 
-// The following class defines an instruction, represented in both
-// 	undecoded binary form
-//      decoded to identify
-//	    operation to do
-//	    registers to act on
-//	    any immediate operand value
-
-class Instruction {
-  public:
-    void Decode();	// decode the binary representation of the instruction
-
-    unsigned int value; // binary representation of the instruction
-
-    char opCode;     // Type of instruction.  This is NOT the same as the
-    		     // opcode field from the instruction: see defs in mips.h
-    char rs, rt, rd; // Three registers from instruction.
-    int extra;       // Immediate or target or shamt field or offset.
-                     // Immediates are sign-extended.
-};
-
 //----------------------------------------------------------------------
 // Machine::Run
 // 	Simulate the execution of a user-level program on Nachos.
@@ -51,21 +31,49 @@ class Instruction {
 //
 //	This routine is re-entrant, in that it can be called multiple
 //	times concurrently -- one for each thread executing user code.
+//
+//	Most instructions end long before the next interrupt is due, and
+//	then all OneTick would do is advance the clock; so we do just that
+//	here, and only call OneTick once an interrupt could fire.  Time
+//	advances exactly as before.  We run a block of instructions at a
+//	time (see RunBlock), as many as can finish before anything is due.
+//
+//	Debugging interrupts prints every tick, and tracing addresses
+//	prints every fetch, so then (or when single-stepping) we run one
+//	instruction at a time and always call OneTick.
 //----------------------------------------------------------------------
 
 void
 Machine::Run()
 {
-    Instruction *instr = new Instruction;  // storage for decoded instruction
+    Interrupt *interrupt = kernel->interrupt;
+    Statistics *stats = kernel->stats;
+    bool batch = !singleStep && !debug->IsEnabled(dbgInt)
+		&& !debug->IsEnabled(dbgAddr);
+    long long limit;
 
     if (debug->IsEnabled('m')) {
         cout << "Starting program in thread: " << kernel->currentThread->getName();
 	cout << ", at time: " << kernel->stats->totalTicks << "\n";
     }
-    kernel->interrupt->setStatus(UserMode);
+    interrupt->setStatus(UserMode);
     for (;;) {
-        OneInstruction(instr);
-		kernel->interrupt->OneTick();
+	// All but the last instruction of the block must finish before
+	// the next interrupt is due.
+	limit = 1;
+	if (batch && interrupt->getStatus() == UserMode) {
+	    limit = ((long long) interrupt->getNextDue() - stats->totalTicks)
+			/ UserTick;
+	    limit = max(1LL, min(limit, (long long) PageSize / 4));
+	}
+        RunBlock((int) limit);
+	if (batch && interrupt->getStatus() == UserMode
+		&& stats->totalTicks + UserTick < interrupt->getNextDue()) {
+	    stats->totalTicks += UserTick;	// nothing due yet
+	    stats->userTicks += UserTick;
+	} else {
+	    interrupt->OneTick();
+	}
     }
 }
 
@@ -93,8 +101,24 @@ TypeToReg(RegType reg, Instruction *instr)
 }
 
 //----------------------------------------------------------------------
-// Machine::OneInstruction
-// 	Execute one instruction from a user-level program
+// Machine::RunBlock
+// 	Execute a block of instructions from a user-level program,
+//	starting at the PC: up to the end of the basic block (the delay
+//	slot of a taken branch or jump), or the end of the page, or
+//	"limit" instructions, whichever comes first.  "limit" must be at
+//	least 1.
+//
+//	Only the first instruction of the block is translated.  The rest
+//	follow it on the same physical page, so we take them straight out
+//	of "decodeCache".  Rather than going back around a switch on the
+//	opcode, each instruction jumps directly to the code for the next
+//	one ("threaded" dispatch, using GNU C's labels as values).
+//
+//	Run() charges the time for the last instruction of the block, just
+//	as it did when we ran one instruction at a time.  The time for the
+//	others is added up in "uncountedTicks", and charged at the end of
+//	the block -- or before trapping to the kernel, so the kernel always
+//	sees the same time it would have.
 //
 // 	If there is any kind of exception or interrupt, we invoke the 
 //	exception handler, and when it returns, we return to Run(), which
@@ -116,23 +140,93 @@ TypeToReg(RegType reg, Instruction *instr)
 //----------------------------------------------------------------------
 
 void
-Machine::OneInstruction(Instruction *instr)
+Machine::RunBlock(int limit)
 {
+    static void *dispatch[MaxOpcode + 1];	// code for each opcode
+    Instruction *instr;
+    int physicalAddress;
 #ifdef SIM_FIX
     int byte;       // described in Kane for LWL,LWR,...
 #endif
 
-    int raw;
-    int nextLoadReg = 0; 	
-    int nextLoadValue = 0; 	// record delayed load operation, to apply
+    int nextLoadReg; 	
+    int nextLoadValue; 	// record delayed load operation, to apply
 				// in the future
+    int pcAfter;
+    int sum, diff, tmp, value;
+    unsigned int rs, rt, imm;
+
+    if (dispatch[0] == NULL) {
+	for (int i = 0; i <= MaxOpcode; i++) {
+	    dispatch[i] = &&op_bad;
+	}
+	dispatch[OP_ADD] = &&op_ADD;
+	dispatch[OP_ADDI] = &&op_ADDI;
+	dispatch[OP_ADDIU] = &&op_ADDIU;
+	dispatch[OP_ADDU] = &&op_ADDU;
+	dispatch[OP_AND] = &&op_AND;
+	dispatch[OP_ANDI] = &&op_ANDI;
+	dispatch[OP_BEQ] = &&op_BEQ;
+	dispatch[OP_BGEZ] = &&op_BGEZ;
+	dispatch[OP_BGEZAL] = &&op_BGEZAL;
+	dispatch[OP_BGTZ] = &&op_BGTZ;
+	dispatch[OP_BLEZ] = &&op_BLEZ;
+	dispatch[OP_BLTZ] = &&op_BLTZ;
+	dispatch[OP_BLTZAL] = &&op_BLTZAL;
+	dispatch[OP_BNE] = &&op_BNE;
+	dispatch[OP_DIV] = &&op_DIV;
+	dispatch[OP_DIVU] = &&op_DIVU;
+	dispatch[OP_J] = &&op_J;
+	dispatch[OP_JAL] = &&op_JAL;
+	dispatch[OP_JALR] = &&op_JALR;
+	dispatch[OP_JR] = &&op_JR;
+	dispatch[OP_LB] = &&op_LB;
+	dispatch[OP_LBU] = &&op_LBU;
+	dispatch[OP_LH] = &&op_LH;
+	dispatch[OP_LHU] = &&op_LHU;
+	dispatch[OP_LUI] = &&op_LUI;
+	dispatch[OP_LW] = &&op_LW;
+	dispatch[OP_LWL] = &&op_LWL;
+	dispatch[OP_LWR] = &&op_LWR;
+	dispatch[OP_MFHI] = &&op_MFHI;
+	dispatch[OP_MFLO] = &&op_MFLO;
+	dispatch[OP_MTHI] = &&op_MTHI;
+	dispatch[OP_MTLO] = &&op_MTLO;
+	dispatch[OP_MULT] = &&op_MULT;
+	dispatch[OP_MULTU] = &&op_MULTU;
+	dispatch[OP_NOR] = &&op_NOR;
+	dispatch[OP_OR] = &&op_OR;
+	dispatch[OP_ORI] = &&op_ORI;
+	dispatch[OP_SB] = &&op_SB;
+	dispatch[OP_SH] = &&op_SH;
+	dispatch[OP_SLL] = &&op_SLL;
+	dispatch[OP_SLLV] = &&op_SLLV;
+	dispatch[OP_SLT] = &&op_SLT;
+	dispatch[OP_SLTI] = &&op_SLTI;
+	dispatch[OP_SLTIU] = &&op_SLTIU;
+	dispatch[OP_SLTU] = &&op_SLTU;
+	dispatch[OP_SRA] = &&op_SRA;
+	dispatch[OP_SRAV] = &&op_SRAV;
+	dispatch[OP_SRL] = &&op_SRL;
+	dispatch[OP_SRLV] = &&op_SRLV;
+	dispatch[OP_SUB] = &&op_SUB;
+	dispatch[OP_SUBU] = &&op_SUBU;
+	dispatch[OP_SW] = &&op_SW;
+	dispatch[OP_SWL] = &&op_SWL;
+	dispatch[OP_SWR] = &&op_SWR;
+	dispatch[OP_SYSCALL] = &&op_SYSCALL;
+	dispatch[OP_XOR] = &&op_XOR;
+	dispatch[OP_XORI] = &&op_XORI;
+	dispatch[OP_RES] = &&op_RES;
+	dispatch[OP_UNIMP] = &&op_UNIMP;
+    }
 
-    // Fetch instruction 
-    if (!ReadMem(registers[PCReg], 4, &raw))
+    // Fetch the first instruction
+    instr = FetchInstruction(registers[PCReg], &physicalAddress);
+    if (instr == NULL)
 	return;			// exception occurred
-    instr->value = raw;
-    instr->Decode();
 
+  execute:
     if (debug->IsEnabled('m')) {
         struct OpString *str = &opStrings[instr->opCode];
 	char buf[80];
@@ -144,85 +238,87 @@ Machine::OneInstruction(Instruction *instr)
         cout << "\t" << buf << "\n";
     }
     
+    nextLoadReg = 0;
+    nextLoadValue = 0;
+
     // Compute next pc, but don't install in case there's an error or branch.
-    int pcAfter = registers[NextPCReg] + 4;
-    int sum, diff, tmp, value;
-    unsigned int rs, rt, imm;
+    pcAfter = registers[NextPCReg] + 4;
 
     // Execute the instruction (cf. Kane's book)
-    switch (instr->opCode) {
+    goto *dispatch[(int) instr->opCode];
 	
-      case OP_ADD:
+	
+      op_ADD:
 	sum = registers[instr->rs] + registers[instr->rt];
 	if (!((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ sum) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    goto trapped;
 	}
 	registers[instr->rd] = sum;
-	break;
+	goto retire;
 	
-      case OP_ADDI:
+      op_ADDI:
 	sum = registers[instr->rs] + instr->extra;
 	if (!((registers[instr->rs] ^ instr->extra) & SIGN_BIT) &&
 	    ((instr->extra ^ sum) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    goto trapped;
 	}
 	registers[instr->rt] = sum;
-	break;
+	goto retire;
 	
-      case OP_ADDIU:
+      op_ADDIU:
 	registers[instr->rt] = registers[instr->rs] + instr->extra;
-	break;
+	goto retire;
 	
-      case OP_ADDU:
+      op_ADDU:
 	registers[instr->rd] = registers[instr->rs] + registers[instr->rt];
-	break;
+	goto retire;
 	
-      case OP_AND:
+      op_AND:
 	registers[instr->rd] = registers[instr->rs] & registers[instr->rt];
-	break;
+	goto retire;
 	
-      case OP_ANDI:
+      op_ANDI:
 	registers[instr->rt] = registers[instr->rs] & (instr->extra & 0xffff);
-	break;
+	goto retire;
 	
-      case OP_BEQ:
+      op_BEQ:
 	if (registers[instr->rs] == registers[instr->rt])
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_BGEZAL:
+      op_BGEZAL:
 	registers[R31] = registers[NextPCReg] + 4;
-      case OP_BGEZ:
+      op_BGEZ:
 	if (!(registers[instr->rs] & SIGN_BIT))
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_BGTZ:
+      op_BGTZ:
 	if (registers[instr->rs] > 0)
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_BLEZ:
+      op_BLEZ:
 	if (registers[instr->rs] <= 0)
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_BLTZAL:
+      op_BLTZAL:
 	registers[R31] = registers[NextPCReg] + 4;
-      case OP_BLTZ:
+      op_BLTZ:
 	if (registers[instr->rs] & SIGN_BIT)
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_BNE:
+      op_BNE:
 	if (registers[instr->rs] != registers[instr->rt])
 	    pcAfter = registers[NextPCReg] + IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_DIV:
+      op_DIV:
 	if (registers[instr->rt] == 0) {
 	    registers[LoReg] = 0;
 	    registers[HiReg] = 0;
@@ -230,9 +326,9 @@ Machine::OneInstruction(Instruction *instr)
 	    registers[LoReg] =  registers[instr->rs] / registers[instr->rt];
 	    registers[HiReg] = registers[instr->rs] % registers[instr->rt];
 	}
-	break;
+	goto retire;
 	
-      case OP_DIVU:	  
+      op_DIVU:
 	  rs = (unsigned int) registers[instr->rs];
 	  rt = (unsigned int) registers[instr->rt];
 	  if (rt == 0) {
@@ -244,25 +340,25 @@ Machine::OneInstruction(Instruction *instr)
 	      tmp = rs % rt;
 	      registers[HiReg] = (int) tmp;
 	  }
-	  break;
+	  goto retire;
 	
-      case OP_JAL:
+      op_JAL:
 	registers[R31] = registers[NextPCReg] + 4;
-      case OP_J:
+      op_J:
 	pcAfter = (pcAfter & 0xf0000000) | IndexToAddr(instr->extra);
-	break;
+	goto retire;
 	
-      case OP_JALR:
+      op_JALR:
 	registers[instr->rd] = registers[NextPCReg] + 4;
-      case OP_JR:
+      op_JR:
 	pcAfter = registers[instr->rs];
-	break;
+	goto retire;
 	
-      case OP_LB:
-      case OP_LBU:
+      op_LB:
+      op_LBU:
 	tmp = registers[instr->rs] + instr->extra;
 	if (!ReadMem(tmp, 1, &value))
-	    return;
+	    goto trapped;
 
 	if ((value & 0x80) && (instr->opCode == OP_LB))
 	    value |= 0xffffff00;
@@ -270,17 +366,17 @@ Machine::OneInstruction(Instruction *instr)
 	    value &= 0xff;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
-	break;
+	goto retire;
 	
-      case OP_LH:
-      case OP_LHU:	  
+      op_LH:
+      op_LHU:
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x1) {
 	    RaiseException(AddressErrorException, tmp);
-	    return;
+	    goto trapped;
 	}
 	if (!ReadMem(tmp, 2, &value))
-	    return;
+	    goto trapped;
 
 	if ((value & 0x8000) && (instr->opCode == OP_LH))
 	    value |= 0xffff0000;
@@ -288,26 +384,26 @@ Machine::OneInstruction(Instruction *instr)
 	    value &= 0xffff;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
-	break;
+	goto retire;
       	
-      case OP_LUI:
+      op_LUI:
 	DEBUG(dbgMach, "Executing: LUI r" << instr->rt << ", " << instr->extra);
 	registers[instr->rt] = instr->extra << 16;
-	break;
+	goto retire;
 	
-      case OP_LW:
+      op_LW:
 	tmp = registers[instr->rs] + instr->extra;
 	if (tmp & 0x3) {
 	    RaiseException(AddressErrorException, tmp);
-	    return;
+	    goto trapped;
 	}
 	if (!ReadMem(tmp, 4, &value))
-	    return;
+	    goto trapped;
 	nextLoadReg = instr->rt;
 	nextLoadValue = value;
-	break;
+	goto retire;
     	
-      case OP_LWL:	  
+      op_LWL:
 	tmp = registers[instr->rs] + instr->extra;
 
 #ifdef SIM_FIX
@@ -322,7 +418,7 @@ Machine::OneInstruction(Instruction *instr)
         // DEBUG('P', "Addr 0x%X\n",tmp-byte);
 
         if (!ReadMem(tmp-byte, 4, &value))
-            return;
+            goto trapped;
 #else
 	// ReadMem assumes all 4 byte requests are aligned on an even 
 	// word boundary.  Also, the little endian/big endian swap code would
@@ -330,7 +426,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!ReadMem(tmp, 4, &value))
-	    return;
+	    goto trapped;
 #endif
 
 	if (registers[LoadReg] == instr->rt)
@@ -357,9 +453,9 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	nextLoadReg = instr->rt;
-	break;
+	goto retire;
       	
-      case OP_LWR:
+      op_LWR:
 	tmp = registers[instr->rs] + instr->extra;
 
 #ifdef SIM_FIX
@@ -374,7 +470,7 @@ Machine::OneInstruction(Instruction *instr)
         // DEBUG('P', "Addr 0x%X\n",tmp-byte);
 
         if (!ReadMem(tmp-byte, 4, &value))
-            return;
+            goto trapped;
 #else
 	// ReadMem assumes all 4 byte requests are aligned on an even 
 	// word boundary.  Also, the little endian/big endian swap code would
@@ -382,7 +478,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!ReadMem(tmp, 4, &value))
-	    return;
+	    goto trapped;
 #endif
 
 	if (registers[LoadReg] == instr->rt)
@@ -413,141 +509,141 @@ Machine::OneInstruction(Instruction *instr)
 	    break;
 	}
 	nextLoadReg = instr->rt;
-	break;
+	goto retire;
     	
-      case OP_MFHI:
+      op_MFHI:
 	registers[instr->rd] = registers[HiReg];
-	break;
+	goto retire;
 	
-      case OP_MFLO:
+      op_MFLO:
 	registers[instr->rd] = registers[LoReg];
-	break;
+	goto retire;
 	
-      case OP_MTHI:
+      op_MTHI:
 	registers[HiReg] = registers[instr->rs];
-	break;
+	goto retire;
 	
-      case OP_MTLO:
+      op_MTLO:
 	registers[LoReg] = registers[instr->rs];
-	break;
+	goto retire;
 	
-      case OP_MULT:
+      op_MULT:
 	Mult(registers[instr->rs], registers[instr->rt], TRUE,
 	     &registers[HiReg], &registers[LoReg]);
-	break;
+	goto retire;
 	
-      case OP_MULTU:
+      op_MULTU:
 	Mult(registers[instr->rs], registers[instr->rt], FALSE,
 	     &registers[HiReg], &registers[LoReg]);
-	break;
+	goto retire;
 	
-      case OP_NOR:
+      op_NOR:
 	registers[instr->rd] = ~(registers[instr->rs] | registers[instr->rt]);
-	break;
+	goto retire;
 	
-      case OP_OR:
+      op_OR:
 	registers[instr->rd] = registers[instr->rs] | registers[instr->rt];
-	break;
+	goto retire;
 	
-      case OP_ORI:
+      op_ORI:
 	registers[instr->rt] = registers[instr->rs] | (instr->extra & 0xffff);
-	break;
+	goto retire;
 	
-      case OP_SB:
+      op_SB:
 	if (!WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 1, registers[instr->rt]))
-	    return;
-	break;
+	    goto trapped;
+	goto retire;
 	
-      case OP_SH:
+      op_SH:
 	if (!WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 2, registers[instr->rt]))
-	    return;
-	break;
+	    goto trapped;
+	goto retire;
 	
-      case OP_SLL:
+      op_SLL:
 	registers[instr->rd] = registers[instr->rt] << instr->extra;
-	break;
+	goto retire;
 	
-      case OP_SLLV:
+      op_SLLV:
 	registers[instr->rd] = registers[instr->rt] <<
 	    (registers[instr->rs] & 0x1f);
-	break;
+	goto retire;
 	
-      case OP_SLT:
+      op_SLT:
 	if (registers[instr->rs] < registers[instr->rt])
 	    registers[instr->rd] = 1;
 	else
 	    registers[instr->rd] = 0;
-	break;
+	goto retire;
 	
-      case OP_SLTI:
+      op_SLTI:
 	if (registers[instr->rs] < instr->extra)
 	    registers[instr->rt] = 1;
 	else
 	    registers[instr->rt] = 0;
-	break;
+	goto retire;
 	
-      case OP_SLTIU:	  
+      op_SLTIU:
 	rs = registers[instr->rs];
 	imm = instr->extra;
 	if (rs < imm)
 	    registers[instr->rt] = 1;
 	else
 	    registers[instr->rt] = 0;
-	break;
+	goto retire;
       	
-      case OP_SLTU:	  
+      op_SLTU:
 	rs = registers[instr->rs];
 	rt = registers[instr->rt];
 	if (rs < rt)
 	    registers[instr->rd] = 1;
 	else
 	    registers[instr->rd] = 0;
-	break;
+	goto retire;
       	
-      case OP_SRA:
+      op_SRA:
 	registers[instr->rd] = registers[instr->rt] >> instr->extra;
-	break;
+	goto retire;
 	
-      case OP_SRAV:
+      op_SRAV:
 	registers[instr->rd] = registers[instr->rt] >>
 	    (registers[instr->rs] & 0x1f);
-	break;
+	goto retire;
 	
-      case OP_SRL:
+      op_SRL:
 	tmp = registers[instr->rt];
 	tmp >>= instr->extra;
 	registers[instr->rd] = tmp;
-	break;
+	goto retire;
 	
-      case OP_SRLV:
+      op_SRLV:
 	tmp = registers[instr->rt];
 	tmp >>= (registers[instr->rs] & 0x1f);
 	registers[instr->rd] = tmp;
-	break;
+	goto retire;
 	
-      case OP_SUB:	  
+      op_SUB:
 	diff = registers[instr->rs] - registers[instr->rt];
 	if (((registers[instr->rs] ^ registers[instr->rt]) & SIGN_BIT) &&
 	    ((registers[instr->rs] ^ diff) & SIGN_BIT)) {
 	    RaiseException(OverflowException, 0);
-	    return;
+	    goto trapped;
 	}
 	registers[instr->rd] = diff;
-	break;
+	goto retire;
       	
-      case OP_SUBU:
+      op_SUBU:
 	registers[instr->rd] = registers[instr->rs] - registers[instr->rt];
-	break;
+	goto retire;
 	
-      case OP_SW:
+      op_SW:
 	if (!WriteMem((unsigned) 
 		(registers[instr->rs] + instr->extra), 4, registers[instr->rt]))
-	    return;
-	break;
+	    goto trapped;
+	goto retire;
 	
-      case OP_SWL:	  
+      op_SWL:
 	tmp = registers[instr->rs] + instr->extra;
 
 #ifdef SIM_FIX
@@ -560,7 +656,7 @@ Machine::OneInstruction(Instruction *instr)
         byte = tmp & 0x3;
         // DEBUG('P', "Addr 0x%X\n",tmp-byte);
         if (!ReadMem(tmp-byte, 4, &value))
-            return;
+            goto trapped;
 
         // DEBUG('P', "Value 0x%X\n",value);
 #else
@@ -570,7 +666,7 @@ Machine::OneInstruction(Instruction *instr)
 	ASSERT((tmp & 0x3) == 0);  
 
 	if (!ReadMem((tmp & ~0x3), 4, &value))
-	    return;
+	    goto trapped;
 #endif
 
 #ifdef SIM_FIX
@@ -597,16 +693,16 @@ Machine::OneInstruction(Instruction *instr)
 	}
 #ifndef SIM_FIX
         if (!WriteMem((tmp & ~0x3), 4, value))
-            return;
+            goto trapped;
 #else
         // DEBUG('P', "Value 0x%X\n",value);
 
         if (!WriteMem((tmp - byte), 4, value))
-            return;
+            goto trapped;
 #endif // SIM_FIX
-	break;
+	goto retire;
     	
-      case OP_SWR:	  
+      op_SWR:
 	tmp = registers[instr->rs] + instr->extra;
 
 #ifndef SIM_FIX
@@ -615,7 +711,7 @@ Machine::OneInstruction(Instruction *instr)
         ASSERT((tmp & 0x3) == 0);  
 
         if (!ReadMem((tmp & ~0x3), 4, &value))
-            return;
+            goto trapped;
 #else
         // The only difference between this code and the BIG ENDIAN code
         // is that the ReadMem call is guaranteed an aligned access as 
@@ -628,7 +724,7 @@ Machine::OneInstruction(Instruction *instr)
         // DEBUG('P', "Addr 0x%X\n",tmp-byte);
 
         if (!ReadMem(tmp-byte, 4, &value))
-            return;
+            goto trapped;
         // DEBUG('P', "Value 0x%X\n",value);
 #endif // SIM_FIX
 
@@ -654,39 +750,40 @@ Machine::OneInstruction(Instruction *instr)
 
 #ifndef SIM_FIX
         if (!WriteMem((tmp & ~0x3), 4, value))
-            return;
+            goto trapped;
 #else
         // DEBUG('P', "Value 0x%X\n",value);
 
         if (!WriteMem((tmp - byte), 4, value))
-            return;
+            goto trapped;
 #endif // SIM_FIX
 
 
-	break;
+	goto retire;
     	
-      case OP_SYSCALL:
-	DEBUG(dbgTraCode, "In Machine::OneInstruction, RaiseException(SyscallException, 0), " << kernel->stats->totalTicks);
+      op_SYSCALL:
+	CountTicks();
+	DEBUG(dbgTraCode, "In Machine::RunBlock, RaiseException(SyscallException, 0), " << kernel->stats->totalTicks);
 	RaiseException(SyscallException, 0);
-	return; 
+	goto trapped; 
 	
-      case OP_XOR:
+      op_XOR:
 	registers[instr->rd] = registers[instr->rs] ^ registers[instr->rt];
-	break;
+	goto retire;
 	
-      case OP_XORI:
+      op_XORI:
 	registers[instr->rt] = registers[instr->rs] ^ (instr->extra & 0xffff);
-	break;
+	goto retire;
 	
-      case OP_RES:
-      case OP_UNIMP:
+      op_RES:
+      op_UNIMP:
 	RaiseException(IllegalInstrException, 0);
-	return;
+	goto trapped;
 	
-      default:
+      op_bad:
 	ASSERT(FALSE);
-    }
     
+  retire:
     // Now we have successfully executed the instruction.
     
     // Do any delayed load operation
@@ -697,6 +794,85 @@ Machine::OneInstruction(Instruction *instr)
 						// are jumping into lala-land
     registers[PCReg] = registers[NextPCReg];
     registers[NextPCReg] = pcAfter;
+
+    // Go on to the next instruction, unless the block ends here.  
+    // A taken branch or jump ends it after its delay slot, since then
+    // the PC doesn't just move on to the next word.
+    physicalAddress += 4;
+    if (--limit == 0 || registers[PCReg] != registers[PrevPCReg] + 4
+		|| physicalAddress % PageSize == 0) {
+	CountTicks();
+	return;
+    }
+    uncountedTicks += UserTick;
+    instr = Decoded(physicalAddress);
+    goto execute;
+
+  trapped:
+    return;			// RaiseException charged the time so far
+}
+
+//----------------------------------------------------------------------
+// Machine::FetchInstruction
+// 	Fetch the instruction at virtual address "addr", decoded, and
+//	set "*physAddr" to where it is in physical memory.  The address
+//	is translated like any other read.
+//
+//	Returns NULL if the translation failed (the exception has
+//	already been raised).
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::FetchInstruction(int addr, int *physAddr)
+{
+    ExceptionType exception;
+
+    DEBUG(dbgAddr, "Reading VA " << addr << ", size 4");
+
+    exception = Translate(addr, physAddr, 4, FALSE);
+    if (exception != NoException) {
+	RaiseException(exception, addr);
+	return NULL;
+    }
+    return Decoded(*physAddr);
+}
+
+//----------------------------------------------------------------------
+// Machine::Decoded
+// 	Return the instruction at physical address "physAddr", decoded.
+//	Each word of physical memory is only decoded the first time it is
+//	run; after that, it comes out of "decodeCache".
+//
+//	The entry can be used in place while its instruction runs: if the
+//	instruction writes to the page, InvalidateCode only clears the
+//	opcode, and an instruction is done with its opcode by then.
+//----------------------------------------------------------------------
+
+Instruction *
+Machine::Decoded(int physAddr)
+{
+    Instruction *decoded = &decodeCache[physAddr / 4];
+
+    if (decoded->opCode == 0) {
+	decoded->value = WordToHost(*(unsigned int *) &mainMemory[physAddr]);
+	decoded->Decode();
+	hasCode[physAddr / PageSize] = TRUE;
+    }
+    return decoded;
+}
+
+//----------------------------------------------------------------------
+// Machine::CountTicks
+// 	Charge the time for the instructions RunBlock has run but not yet
+//	accounted for.
+//----------------------------------------------------------------------
+
+void
+Machine::CountTicks()
+{
+    kernel->stats->totalTicks += uncountedTicks;
+    kernel->stats->userTicks += uncountedTicks;
+    uncountedTicks = 0;
 }
 
 //----------------------------------------------------------------------
@@ -20,8 +20,11 @@ Statistics::Statistics()
 {
     totalTicks = idleTicks = systemTicks = userTicks = 0;
     numDiskReads = numDiskWrites = 0;
+    numDiskCacheHits = numDiskCacheMisses = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numTLBHits = numTLBMisses = numTLBRefills = 0;
+    numSwapReads = numSwapWrites = 0;
 }
 
 //----------------------------------------------------------------------
@@ -37,9 +40,22 @@ Statistics::Print()
 		cout << ", system " << systemTicks << ", user " << userTicks <<"\n";
     cout << "Disk I/O: reads " << numDiskReads;
 		cout << ", writes " << numDiskWrites << "\n";
+    if (numDiskCacheHits + numDiskCacheMisses > 0) {	// only if it was used
+	cout << "Disk cache: hits " << numDiskCacheHits;
+	cout << ", misses " << numDiskCacheMisses << "\n";
+    }
 		cout << "Console I/O: reads " << numConsoleCharsRead;
     cout << ", writes " << numConsoleCharsWritten << "\n";
-    cout << "Paging: faults " << numPageFaults << "\n";
+    cout << "Paging: faults " << numPageFaults;
+    if (numSwapReads + numSwapWrites > 0) {	// only if we ran out of memory
+	cout << ", swap reads " << numSwapReads;
+	cout << ", swap writes " << numSwapWrites;
+    }
+    cout << "\n";
+    if (numTLBHits + numTLBMisses > 0) {	// only if there is a TLB
+	cout << "TLB: hits " << numTLBHits << ", misses " << numTLBMisses;
+	cout << ", refills " << numTLBRefills << "\n";
+    }
     cout << "Network I/O: packets received " << numPacketsRecvd;
 		cout << ", sent " << numPacketsSent << "\n";
 }
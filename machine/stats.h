@@ -30,9 +30,16 @@ class Statistics {
 
     int numDiskReads;		// number of disk read requests
     int numDiskWrites;		// number of disk write requests
+    int numDiskCacheHits;	// sectors found in the disk cache
+    int numDiskCacheMisses;	// sectors that had to be made room for
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numSwapReads;		// pages read back in from swap space
+    int numSwapWrites;		// dirty pages written out to swap space
+    int numTLBHits;		// translations found in the TLB
+    int numTLBMisses;		// translations not found in the TLB
+    int numTLBRefills;		// misses the kernel loaded into the TLB
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
@@ -0,0 +1,541 @@
+// timingwheel.cc
+//	Routines to keep track of pending interrupts on a hierarchical
+//	timing wheel.  See timingwheel.h for how the wheel is laid out.
+//
+//	An interrupt on level L shares every bit of its time above the
+//	bits for level L with the wheel's current time, and differs from
+//	it in the bits for level L.  So everything on level 0 is due
+//	within the current WheelSlots ticks, at the time of its slot;
+//	and everything on level L is due before anything on level L+1.
+//
+//	Times are compared modulo 2^32, as distances from the wheel's
+//	current time, so the wheel keeps working when the tick counter
+//	wraps around.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "timingwheel.h"
+#include "debug.h"
+#include "list.h"
+#include "sysdep.h"
+
+//----------------------------------------------------------------------
+// WheelLevel
+//	Return the level an interrupt at time "when" belongs on, if the
+//	wheel is at time "current"; WheelLevels means the overflow list.
+//----------------------------------------------------------------------
+
+static int
+WheelLevel(int when, int current)
+{
+    unsigned int diff = (unsigned int) (when ^ current);
+    int level;
+
+    if (diff < (unsigned int) WheelSlots) {
+	return 0;
+    }
+    level = (31 - __builtin_clz(diff)) / WheelSlotBits;
+    return (level < WheelLevels) ? level : WheelLevels;
+}
+
+//----------------------------------------------------------------------
+// Distance
+//	Return how far "when" is past "current".
+//----------------------------------------------------------------------
+
+static unsigned int
+Distance(int when, int current)
+{
+    return (unsigned int) when - (unsigned int) current;
+}
+
+//----------------------------------------------------------------------
+// SlotInsert
+//	Put an interrupt on a slot, keeping it in order of "seq".  Almost
+//	always the interrupt is the newest one, so it goes at the end.
+//----------------------------------------------------------------------
+
+static void
+SlotInsert(PendingInterrupt **first, PendingInterrupt **last,
+					PendingInterrupt *toOccur)
+{
+    PendingInterrupt *ptr;
+
+    toOccur->next = NULL;
+    if (*first == NULL) {
+	*first = *last = toOccur;
+    } else if ((int) ((*last)->seq - toOccur->seq) < 0) {
+	(*last)->next = toOccur;
+	*last = toOccur;
+    } else if ((int) (toOccur->seq - (*first)->seq) < 0) {
+	toOccur->next = *first;
+	*first = toOccur;
+    } else {
+	for (ptr = *first; (int) (ptr->next->seq - toOccur->seq) < 0;
+							ptr = ptr->next) {
+	}
+	toOccur->next = ptr->next;
+	ptr->next = toOccur;
+    }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::TimingWheel
+//	Initialize an empty wheel, at time 0.
+//----------------------------------------------------------------------
+
+TimingWheel::TimingWheel()
+{
+    for (int level = 0; level < WheelLevels; level++) {
+	for (int i = 0; i < WheelSlots; i++) {
+	    slots[level][i].first = slots[level][i].last = NULL;
+	}
+	inUse[level] = 0;
+    }
+    overflow.first = overflow.last = NULL;
+    current = 0;
+    nextDue = NeverDue;
+    numPending = 0;
+    numInserted = 0;
+    pool = NULL;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::~TimingWheel
+//	De-allocate the interrupts still on the wheel, and the pool.
+//----------------------------------------------------------------------
+
+TimingWheel::~TimingWheel()
+{
+    PendingInterrupt *ptr;
+
+    while (!IsEmpty()) {
+	Free(RemoveFront());
+    }
+    while (pool != NULL) {
+	ptr = pool;
+	pool = pool->next;
+	delete ptr;
+    }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Allocate
+//	Get an interrupt from the pool, or make a new one if the pool
+//	is empty.
+//
+//	"callTo" is the object to call when the interrupt occurs
+//	"when" is when (in simulated time) the interrupt is to occur
+//	"type" is the hardware device that generated the interrupt
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+TimingWheel::Allocate(CallBackObj *callTo, int when, IntType type)
+{
+    PendingInterrupt *toOccur;
+
+    if (pool == NULL) {
+	return new PendingInterrupt(callTo, when, type);
+    }
+    toOccur = pool;
+    pool = pool->next;
+    toOccur->callOnInterrupt = callTo;
+    toOccur->when = when;
+    toOccur->type = type;
+    toOccur->next = NULL;
+    return toOccur;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Free
+//	Put an interrupt that is off the wheel back in the pool.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Free(PendingInterrupt *toFree)
+{
+    toFree->next = pool;
+    pool = toFree;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::DueTime
+//	Return when an interrupt is due on the wheel: its time, unless
+//	that is already behind the wheel's time, in which case it is due
+//	right away.
+//----------------------------------------------------------------------
+
+int
+TimingWheel::DueTime(PendingInterrupt *toOccur)
+{
+    if ((int) Distance(toOccur->when, current) < 0) {
+	return current;
+    }
+    return toOccur->when;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Place
+//	Put an interrupt on the slot for its time, relative to the
+//	wheel's current time.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Place(PendingInterrupt *toOccur)
+{
+    int due = DueTime(toOccur);
+    int level = WheelLevel(due, current);
+    int i;
+
+    if (level == WheelLevels) {
+	SlotInsert(&overflow.first, &overflow.last, toOccur);
+	return;
+    }
+    i = (due >> (level * WheelSlotBits)) & (WheelSlots - 1);
+    SlotInsert(&slots[level][i].first, &slots[level][i].last, toOccur);
+    inUse[level] |= 1ULL << i;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Insert
+//	Schedule an interrupt.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Insert(PendingInterrupt *toOccur)
+{
+    int due = DueTime(toOccur);
+
+    toOccur->seq = numInserted++;
+    Place(toOccur);
+    if (numPending == 0 || Distance(due, current) < Distance(nextDue, current)) {
+	nextDue = due;
+    }
+    numPending++;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Advance
+//	Move the wheel's time up to "now", the time of the first pending
+//	interrupt.  Nothing is due before "now", so the only interrupts
+//	that need to move are the ones on the same slot as the first:
+//	they now belong on lower levels.  Everything due at "now" ends
+//	up on level 0, still in order of "seq".
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Advance(int now)
+{
+    int level = WheelLevel(now, current);
+    PendingInterrupt *ptr, *next;
+    int i;
+
+    current = now;
+    if (level == 0) {
+	return;
+    }
+    if (level == WheelLevels) {
+	ptr = overflow.first;
+	overflow.first = overflow.last = NULL;
+    } else {
+	i = (now >> (level * WheelSlotBits)) & (WheelSlots - 1);
+	ptr = slots[level][i].first;
+	slots[level][i].first = slots[level][i].last = NULL;
+	inUse[level] &= ~(1ULL << i);
+    }
+    for (; ptr != NULL; ptr = next) {
+	next = ptr->next;
+	Place(ptr);
+    }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::FindNextDue
+//	Find when the first pending interrupt is due.  It is on the
+//	lowest level with anything on it, in the first slot in use; on
+//	level 0 that slot gives its time, but on the levels above we
+//	have to look through the slot.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::FindNextDue()
+{
+    PendingInterrupt *ptr = NULL;
+
+    nextDue = NeverDue;
+    for (int level = 0; level < WheelLevels; level++) {
+	if (inUse[level] != 0) {
+	    int i = __builtin_ctzll(inUse[level]);
+
+	    if (level == 0) {
+		nextDue = (current & ~(WheelSlots - 1)) | i;
+		return;
+	    }
+	    ptr = slots[level][i].first;
+	    break;
+	}
+    }
+    if (ptr == NULL) {
+	ptr = overflow.first;
+    }
+    if (ptr != NULL) {
+	nextDue = ptr->when;
+    }
+    for (; ptr != NULL; ptr = ptr->next) {
+	if (Distance(ptr->when, current) < Distance(nextDue, current)) {
+	    nextDue = ptr->when;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Front
+//	Return the interrupt that is to occur first, without taking it
+//	off the wheel.  This moves the wheel's time up to when it is due.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+TimingWheel::Front()
+{
+    ASSERT(!IsEmpty());
+
+    if (nextDue != current) {
+	Advance(nextDue);
+    }
+    return slots[0][current & (WheelSlots - 1)].first;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::RemoveFront
+//	Take the interrupt that is to occur first off the wheel, and
+//	return it.
+//----------------------------------------------------------------------
+
+PendingInterrupt *
+TimingWheel::RemoveFront()
+{
+    PendingInterrupt *toOccur = Front();
+    Slot *slot = &slots[0][current & (WheelSlots - 1)];
+
+    slot->first = toOccur->next;
+    toOccur->next = NULL;
+    numPending--;
+    if (slot->first == NULL) {
+	slot->last = NULL;
+	inUse[0] &= ~(1ULL << (current & (WheelSlots - 1)));
+	FindNextDue();
+    }
+    return toOccur;
+}
+
+//----------------------------------------------------------------------
+// PendingCompare
+//	Compare two interrupts based on which should occur first.
+//----------------------------------------------------------------------
+
+static int
+PendingCompare(PendingInterrupt *x, PendingInterrupt *y)
+{
+    if (x->when < y->when) { return -1; }
+    else if (x->when > y->when) { return 1; }
+    else if ((int) (x->seq - y->seq) < 0) { return -1; }
+    else if (x->seq == y->seq) { return 0; }
+    else { return 1; }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Apply
+//	Apply function to every pending interrupt, in the order they
+//	will occur.  Only used for debugging, so we just sort them.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Apply(void (*func)(PendingInterrupt *))
+{
+    SortedList<PendingInterrupt *> *sorted =
+			new SortedList<PendingInterrupt *>(PendingCompare);
+    PendingInterrupt *ptr;
+
+    for (int level = 0; level < WheelLevels; level++) {
+	for (int i = 0; i < WheelSlots; i++) {
+	    for (ptr = slots[level][i].first; ptr != NULL; ptr = ptr->next) {
+		sorted->Insert(ptr);
+	    }
+	}
+    }
+    for (ptr = overflow.first; ptr != NULL; ptr = ptr->next) {
+	sorted->Insert(ptr);
+    }
+    sorted->Apply(func);
+    delete sorted;
+}
+
+//----------------------------------------------------------------------
+// WheelDelay
+//	Pick how far in the future to schedule an interrupt, from a mix
+//	like the devices': lots of one-tick polls, the timer, disk
+//	seeks, and once in a while something far enough away to end up
+//	on the overflow list.
+//----------------------------------------------------------------------
+
+static int
+WheelDelay()
+{
+    switch (RandomNumber() % 8) {
+      case 0: case 1: case 2:
+	return 1;
+      case 3:
+	return 100;
+      case 4:
+	return 1 + RandomNumber() % 200;
+      case 5:
+	return 1 + RandomNumber() % 5000;
+      case 6:
+	return 1 + RandomNumber() % 300000;
+      default:
+	if (RandomNumber() % 16 == 0) {
+	    return 1 + RandomNumber() % (1 << 26);
+	}
+	return 1 + RandomNumber() % 5000;
+    }
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::SelfTest
+//	Test whether this module is working, by scheduling and firing
+//	interrupts on a wheel and a sorted list side by side, and checking
+//	that they come off in the same order.  We stop well before the
+//	tick counter could wrap around, which the sorted list can't handle.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::SelfTest()
+{
+    TimingWheel *wheel = new TimingWheel();
+    SortedList<PendingInterrupt *> *list =
+			new SortedList<PendingInterrupt *>(PendingCompare);
+    PendingInterrupt *fromWheel, *fromList;
+    int now = 0;
+    int i;
+
+    RandomInit(1);
+    for (i = 0; i < 100; i++) {
+	fromWheel = wheel->Allocate(NULL, now + WheelDelay(), TimerInt);
+	wheel->Insert(fromWheel);
+	list->Insert(fromWheel);
+    }
+    for (i = 0; i < 100000 && now < (1 << 30); i++) {
+	ASSERT(wheel->NextDue() == list->Front()->when);
+	fromWheel = wheel->RemoveFront();
+	fromList = list->RemoveFront();
+	ASSERT(fromWheel == fromList);
+	now = fromWheel->when;
+	wheel->Free(fromWheel);
+
+	// re-arm, sometimes twice at the same time, so there are ties
+	fromWheel = wheel->Allocate(NULL, now + WheelDelay(), TimerInt);
+	wheel->Insert(fromWheel);
+	list->Insert(fromWheel);
+	if (RandomNumber() % 4 == 0) {
+	    fromWheel = wheel->Allocate(NULL, fromWheel->when, DiskInt);
+	    wheel->Insert(fromWheel);
+	    list->Insert(fromWheel);
+	}
+	if (RandomNumber() % 4 == 0 && list->NumInList() > 50) {
+						// and sometimes don't
+	    fromWheel = wheel->RemoveFront();
+	    ASSERT(fromWheel == list->RemoveFront());
+	    now = fromWheel->when;
+	    wheel->Free(fromWheel);
+	}
+    }
+    while (!list->IsEmpty()) {
+	ASSERT(wheel->RemoveFront() == list->RemoveFront());
+    }
+    ASSERT(wheel->IsEmpty() && wheel->NextDue() == NeverDue);
+    delete list;
+    delete wheel;
+}
+
+//----------------------------------------------------------------------
+// WheelEvents
+//	Keep "n" interrupts pending, firing the first and re-arming it
+//	"rounds" times -- what the devices do all the time.  Either
+//	the wheel or the sorted list is used, whichever is non-NULL;
+//	both see the same sequence.  Returns events per host second.
+//----------------------------------------------------------------------
+
+static const int wheelRounds = 200000;
+
+static double
+WheelEvents(TimingWheel *wheel, SortedList<PendingInterrupt *> *list, int n)
+{
+    PendingInterrupt *toOccur;
+    unsigned int seq = 0;
+    double start;
+    int i;
+
+    RandomInit(n);
+    for (i = 0; i < n; i++) {
+	if (wheel != NULL) {
+	    wheel->Insert(wheel->Allocate(NULL, WheelDelay(), TimerInt));
+	} else {
+	    toOccur = new PendingInterrupt(NULL, WheelDelay(), TimerInt);
+	    toOccur->seq = seq++;
+	    list->Insert(toOccur);
+	}
+    }
+    start = HostTime();
+    for (i = 0; i < wheelRounds; i++) {
+	if (wheel != NULL) {
+	    toOccur = wheel->RemoveFront();
+	    wheel->Free(toOccur);
+	    wheel->Insert(wheel->Allocate(NULL, toOccur->when + WheelDelay(),
+								TimerInt));
+	} else {
+	    toOccur = list->RemoveFront();
+	    int when = toOccur->when + WheelDelay();
+	    delete toOccur;
+	    toOccur = new PendingInterrupt(NULL, when, TimerInt);
+	    toOccur->seq = seq++;
+	    list->Insert(toOccur);
+	}
+    }
+    start = HostTime() - start;
+    if (list != NULL) {
+	while (!list->IsEmpty()) {
+	    delete list->RemoveFront();
+	}
+    }
+    return wheelRounds / start;
+}
+
+//----------------------------------------------------------------------
+// TimingWheel::Benchmark
+//	Compare a sorted list against a timing wheel as the list of
+//	pending interrupts, as the number of pending interrupts grows.
+//----------------------------------------------------------------------
+
+void
+TimingWheel::Benchmark()
+{
+    cout << "Pending interrupt benchmark: " << wheelRounds
+	 << " fire/re-arm rounds, events per host second\n";
+    cout << "pending\tSortedList\tTimingWheel\n";
+    for (int n = 4; n <= 1024; n *= 4) {
+	SortedList<PendingInterrupt *> *list =
+			new SortedList<PendingInterrupt *>(PendingCompare);
+	TimingWheel *wheel = new TimingWheel();
+	double listRate = WheelEvents(NULL, list, n);
+	double wheelRate = WheelEvents(wheel, NULL, n);
+
+	cout << n << "\t" << listRate << "\t\t" << wheelRate << "\n";
+	delete list;
+	delete wheel;
+    }
+}
@@ -0,0 +1,98 @@
+// timingwheel.h
+//	Data structures for keeping track of the interrupts that are
+//	scheduled to occur in the future.
+//
+//	The interrupts are kept on a hierarchical timing wheel: an array
+//	of slots for each of WheelLevels levels.  Level 0 has a slot for
+//	each of the next WheelSlots ticks; each slot on level 1 covers
+//	WheelSlots ticks of level 0, and so on.  An interrupt goes on the
+//	level where its time first differs from the wheel's current time,
+//	and moves down ("cascades") when the wheel's time gets that far.
+//	Interrupts too far away for the top level wait on an overflow list.
+//
+//	So, unlike a sorted list, scheduling an interrupt and firing it
+//	take constant time, however many are pending.  Interrupts due at
+//	the same tick fire in the order they were scheduled, just as they
+//	would off a sorted list.
+//
+//	The wheel also keeps a pool of PendingInterrupts, so the devices
+//	re-arming their interrupts don't allocate memory every time.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include "copyright.h"
+#include "interrupt.h"
+
+const int WheelLevels = 4;		// levels of slots
+const int WheelSlotBits = 6;
+const int WheelSlots = 1 << WheelSlotBits; // slots per level
+
+// The following class defines a hierarchical timing wheel of pending
+// interrupts, ordered by "when", and among equal times, by "seq".
+//
+// The wheel's current time only moves forward, and only as far as the
+// first interrupt the caller has asked for (Front).  An interrupt
+// scheduled before that is due right away.  The interrupt simulation
+// never schedules one: it only looks at an interrupt once it is due,
+// and only schedules ones in the future.
+
+class TimingWheel {
+  public:
+    TimingWheel();			// initialize an empty wheel
+    ~TimingWheel();			// de-allocate every interrupt,
+					// including those in the pool
+
+    PendingInterrupt *Allocate(CallBackObj *callTo, int when, IntType type);
+					// get an interrupt from the pool
+    void Free(PendingInterrupt *toFree);
+					// put it back in the pool
+
+    void Insert(PendingInterrupt *toOccur);
+					// schedule an interrupt
+    PendingInterrupt *Front();		// interrupt to occur first;
+					// moves the wheel up to its time
+    PendingInterrupt *RemoveFront();	// take it off the wheel
+
+    bool IsEmpty() { return (numPending == 0); }
+    int NextDue() { return nextDue; }	// "when" of the first interrupt,
+					// or NeverDue if there is none
+    void Apply(void (*func)(PendingInterrupt *));
+					// apply function to every interrupt,
+					// in the order they will occur
+
+    static void SelfTest();		// test whether it is working
+    static void Benchmark();		// compare speed with a sorted list
+
+  private:
+    struct Slot {
+	PendingInterrupt *first;	// in order of "seq"
+	PendingInterrupt *last;
+    };
+
+    Slot slots[WheelLevels][WheelSlots];
+    unsigned long long inUse[WheelLevels];
+					// bit i set iff slots[level][i]
+					// is not empty
+    Slot overflow;			// too far away for the top level
+    int current;			// time the wheel has moved up to
+    int nextDue;			// cached "when" of Front()
+    int numPending;			// interrupts on the wheel
+    unsigned int numInserted;		// to number interrupts ("seq")
+    PendingInterrupt *pool;		// free interrupts, linked by "next"
+
+    int DueTime(PendingInterrupt *toOccur);
+					// when it is due on the wheel
+    void Place(PendingInterrupt *toOccur);
+					// put on the slot for its time
+    void Advance(int now);		// move the wheel up to "now"
+    void FindNextDue();			// recompute "nextDue"
+};
+
+#endif // TIMINGWHEEL_H
@@ -6,8 +6,8 @@
 //
 // Two types of translation are supported here.
 //
-//	Linear page table -- the virtual page # is used as an index
-//	into the table, to find the physical page #.
+//	Page table -- the virtual page # is looked up in the address
+//	space's page table, to find the physical page #.
 //
 //	Translation lookaside buffer -- associative lookup in the table
 //	to find an entry with the same virtual page #.  If found,
@@ -31,6 +31,7 @@
 
 #include "copyright.h"
 #include "main.h"
+#include "pagetable.h"
 
 // Routines for converting Words and Short Words to and from the
 // simulated machine's format of little endian.  These end up
@@ -88,27 +89,35 @@ Machine::ReadMem(int addr, int size, int *value)
     int data;
     ExceptionType exception;
     int physicalAddress;
+    unsigned int vpn = (unsigned) addr / PageSize;
+    CachedTranslation *cached = &translations[vpn % TranslationCacheSize];
+    char *hostAddress;
     
     DEBUG(dbgAddr, "Reading VA " << addr << ", size " << size);
     
-    exception = Translate(addr, &physicalAddress, size, FALSE);
-    if (exception != NoException) {
-	RaiseException(exception, addr);
-	return FALSE;
+    if (cached->readPage == (int) vpn && (addr & (size - 1)) == 0) {
+	hostAddress = cached->page + (unsigned) addr % PageSize;
+    } else {
+	exception = Translate(addr, &physicalAddress, size, FALSE);
+	if (exception != NoException) {
+	    RaiseException(exception, addr);
+	    return FALSE;
+	}
+	hostAddress = CacheTranslation(addr, physicalAddress, FALSE);
     }
     switch (size) {
       case 1:
-	data = mainMemory[physicalAddress];
+	data = *hostAddress;
 	*value = data;
 	break;
 	
       case 2:
-	data = *(unsigned short *) &mainMemory[physicalAddress];
+	data = *(unsigned short *) hostAddress;
 	*value = ShortToHost(data);
 	break;
 	
       case 4:
-	data = *(unsigned int *) &mainMemory[physicalAddress];
+	data = *(unsigned int *) hostAddress;
 	*value = WordToHost(data);
 	break;
 
@@ -137,31 +146,44 @@ Machine::WriteMem(int addr, int size, int value)
 {
     ExceptionType exception;
     int physicalAddress;
+    unsigned int vpn = (unsigned) addr / PageSize;
+    CachedTranslation *cached = &translations[vpn % TranslationCacheSize];
+    char *hostAddress;
+    int frame;
      
     DEBUG(dbgAddr, "Writing VA " << addr << ", size " << size << ", value " << value);
 
-    exception = Translate(addr, &physicalAddress, size, TRUE);
-    if (exception != NoException) {
-	RaiseException(exception, addr);
-	return FALSE;
+    if (cached->writePage == (int) vpn && (addr & (size - 1)) == 0) {
+	hostAddress = cached->page + (unsigned) addr % PageSize;
+    } else {
+	exception = Translate(addr, &physicalAddress, size, TRUE);
+	if (exception != NoException) {
+	    RaiseException(exception, addr);
+	    return FALSE;
+	}
+	hostAddress = CacheTranslation(addr, physicalAddress, TRUE);
     }
     switch (size) {
       case 1:
-	mainMemory[physicalAddress] = (unsigned char) (value & 0xff);
+	*hostAddress = (unsigned char) (value & 0xff);
 	break;
 
       case 2:
-	*(unsigned short *) &mainMemory[physicalAddress]
+	*(unsigned short *) hostAddress
 		= ShortToMachine((unsigned short) (value & 0xffff));
 	break;
       
       case 4:
-	*(unsigned int *) &mainMemory[physicalAddress]
+	*(unsigned int *) hostAddress
 		= WordToMachine((unsigned int) value);
 	break;
 	
       default: ASSERT(FALSE);
     }
+    frame = (hostAddress - mainMemory) / PageSize;
+    if (hasCode[frame]) {		// self-modifying code?
+	InvalidateCode(frame);
+    }
     
     return TRUE;
 }
@@ -205,27 +227,32 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     vpn = (unsigned) virtAddr / PageSize;
     offset = (unsigned) virtAddr % PageSize;
     
-    if (tlb == NULL) {		// => page table => vpn is index into table
-	if (vpn >= pageTableSize) {
+    if (tlb == NULL) {		// => page table => look vpn up in it
+	entry = pageTable->Translation(vpn);
+	if (entry == NULL) {
 	    DEBUG(dbgAddr, "Illegal virtual page # " << virtAddr);
 	    return AddressErrorException;
-	} else if (!pageTable[vpn].valid) {
+	} else if (!entry->valid) {
 	    DEBUG(dbgAddr, "Invalid virtual page # " << virtAddr);
 	    return PageFaultException;
 	}
-	entry = &pageTable[vpn];
     } else {
-        for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == ((int)vpn))) {
-		entry = &tlb[i];			// FOUND!
+	TranslationEntry *set = &tlb[(vpn % tlbSets) * tlbWays];
+
+        for (entry = NULL, i = 0; i < tlbWays; i++)
+    	    if (set[i].valid && (set[i].virtualPage == ((int)vpn))
+			&& set[i].asid == currentASID) {
+		entry = &set[i];			// FOUND!
 		break;
 	    }
 	if (entry == NULL) {				// not found
     	    DEBUG(dbgAddr, "Invalid TLB entry for this virtual page!");
+	    kernel->stats->numTLBMisses++;
     	    return PageFaultException;		// really, this is a TLB fault,
 						// the page may be in memory,
 						// but not in the TLB
 	}
+	kernel->stats->numTLBHits++;
     }
 
     if (entry->readOnly && writing) {	// trying to write to a read-only page
@@ -248,3 +275,156 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     DEBUG(dbgAddr, "phys addr = " << *physAddr);
     return NoException;
 }
+
+//----------------------------------------------------------------------
+// Machine::UseTLB
+// 	From now on, translate addresses through a TLB of "size" entries,
+//	rather than a page table.  The TLB is split into sets of "ways"
+//	entries; a virtual page can only go in set (page % number of sets).
+//	"ways" == "size" is a fully associative TLB.
+//
+//	There must be at least two ways.  An instruction can need two
+//	translations at once, for itself and for the data it loads or
+//	stores, and in a direct mapped TLB they could keep pushing each
+//	other out.
+//
+//	The TLB starts out empty.  Each miss raises a PageFaultException,
+//	and it is up to the kernel to load the missing translation, with
+//	WriteTLB.
+//----------------------------------------------------------------------
+
+void
+Machine::UseTLB(int size, int ways)
+{
+    ASSERT(ways >= 2 && size >= ways && size % ways == 0);
+    if (tlb != NULL) {
+	delete [] tlb;
+	delete [] tlbNextVictim;
+    }
+    tlbSize = size;
+    tlbWays = ways;
+    tlbSets = size / ways;
+    tlb = new TranslationEntry[tlbSize];
+    for (int i = 0; i < tlbSize; i++) {
+	tlb[i].valid = FALSE;
+    }
+    tlbNextVictim = new int[tlbSets];
+    for (int i = 0; i < tlbSets; i++) {
+	tlbNextVictim[i] = 0;
+    }
+    pageTable = NULL;
+    FlushTranslations();
+}
+
+//----------------------------------------------------------------------
+// Machine::SetASID
+// 	Switch the TLB over to another address space.  Only entries
+//	tagged with "id" match from now on; the others stay in the TLB,
+//	so they needn't be reloaded when their address space runs again.
+//----------------------------------------------------------------------
+
+void
+Machine::SetASID(int id)
+{
+    ASSERT(id >= 0 && id < NumASIDs);
+    currentASID = id;
+    FlushTranslations();
+}
+
+//----------------------------------------------------------------------
+// Machine::WriteTLB
+// 	Load the translation "entry" into the TLB, tagged with the
+//	current address space.  It goes in an empty entry of its set if
+//	there is one, and otherwise replaces the entries of the set in
+//	turn.
+//
+//	Returns TRUE if a valid entry was replaced, after copying it to
+//	"evicted", so the kernel can save its use and dirty bits.
+//----------------------------------------------------------------------
+
+bool
+Machine::WriteTLB(TranslationEntry *entry, TranslationEntry *evicted)
+{
+    int set = (unsigned) entry->virtualPage % tlbSets;
+    TranslationEntry *ways = &tlb[set * tlbWays];
+    TranslationEntry *victim = NULL;
+    bool replaced;
+
+    for (int i = 0; i < tlbWays && victim == NULL; i++) {
+	if (!ways[i].valid) {
+	    victim = &ways[i];
+	}
+    }
+    if (victim == NULL) {
+	victim = &ways[tlbNextVictim[set]];
+	tlbNextVictim[set] = (tlbNextVictim[set] + 1) % tlbWays;
+    }
+    replaced = victim->valid;
+    if (replaced) {
+	CachedTranslation *cached =
+	    &translations[victim->virtualPage % TranslationCacheSize];
+
+	*evicted = *victim;
+	if (victim->asid == currentASID
+		&& cached->readPage == victim->virtualPage) {
+	    cached->readPage = -1;	// ReadMem and WriteMem mustn't
+	    cached->writePage = -1;	// use it either
+	}
+    }
+    *victim = *entry;
+    victim->valid = TRUE;
+    victim->asid = currentASID;
+    DEBUG(dbgAddr, "TLB set " << set << " loaded with page "
+		<< entry->virtualPage << ", address space " << currentASID);
+    return replaced;
+}
+
+//----------------------------------------------------------------------
+// Machine::CacheTranslation
+// 	Remember the translation of "virtAddr" to "physAddr" that
+//	Translate just made for ReadMem, or for WriteMem if "writing", so
+//	the next access to the page can skip Translate.  Returns where
+//	"physAddr" is in "mainMemory".
+//
+//	Translate has set the page's use bit, and its dirty bit if
+//	"writing", so an access that hits in the cache needn't.  That is
+//	why a page that has only been read isn't cached for WriteMem: the
+//	first write to it goes through Translate, to set the dirty bit.
+//
+//	Nothing is cached while addresses are being traced, so that the
+//	trace shows every translation.
+//----------------------------------------------------------------------
+
+char *
+Machine::CacheTranslation(int virtAddr, int physAddr, bool writing)
+{
+    int vpn = (unsigned) virtAddr / PageSize;
+    CachedTranslation *cached = &translations[vpn % TranslationCacheSize];
+
+    if (!debug->IsEnabled(dbgAddr)) {
+	if (cached->readPage != vpn) {	// replacing another page
+	    cached->writePage = -1;
+	}
+	cached->readPage = vpn;
+	if (writing) {
+	    cached->writePage = vpn;
+	}
+	cached->page = &mainMemory[physAddr - (unsigned) virtAddr % PageSize];
+    }
+    return &mainMemory[physAddr];
+}
+
+//----------------------------------------------------------------------
+// Machine::FlushTranslations
+// 	Forget every translation ReadMem and WriteMem have cached, because
+//	the page table or TLB has changed.
+//----------------------------------------------------------------------
+
+void
+Machine::FlushTranslations()
+{
+    for (int i = 0; i < TranslationCacheSize; i++) {
+	translations[i].readPage = -1;
+	translations[i].writePage = -1;
+    }
+}
@@ -41,6 +41,8 @@ Alarm::Alarm(bool doRandom)
 //
 //	For now, just provide time-slicing.  Only need to time slice 
 //      if we're currently running something (in other words, not idle).
+//	Whether the running thread's time is up is for the scheduling
+//	policy to decide.
 //----------------------------------------------------------------------
 
 void 
@@ -50,6 +52,7 @@ Alarm::CallBack()
     MachineStatus status = interrupt->getStatus();
     
     if (status != IdleMode) {
+	    kernel->scheduler->TimerTick();
 	    interrupt->YieldOnReturn();
     }
 }
@@ -13,6 +13,11 @@
 #include "synch.h"
 #include "synchlist.h"
 #include "libtest.h"
+#include "timingwheel.h"
+#include "frametable.h"
+#include "swapspace.h"
+#include "pagecache.h"
+#include "pagetable.h"
 #include "string.h"
 #include "synchdisk.h"
 #include "post.h"
@@ -26,11 +31,18 @@
 
 Kernel::Kernel(int argc, char **argv)
 {
-// *************** MP2 *************** //
-    numAvailPhysPage = NumPhysPages;
-    for(int i = 0; i < NumPhysPages; i++)
-        usedPhysPage[i] = FALSE;
-// *************** MP2 *************** //
+    schedulerType = SJF;
+    predictorType = ExpAverage;
+    predictorParameter = 0.5;
+    tlbSize = 0;
+    tlbWays = 0;
+    replacementType = ClockReplacement;
+    admissionType = FIFOAdmission;
+    diskPolicyType = FCFSDisk;
+    threadNum = 0;
+    for (int i = 0; i < MaxUserThreads; i++) {
+	t[i] = NULL;
+    }
     randomSlice = FALSE; 
     debugUserProg = FALSE;
     consoleIn = NULL;          // default is stdin
@@ -52,7 +64,74 @@ Kernel::Kernel(int argc, char **argv)
             debugUserProg = TRUE;
 		} else if (strcmp(argv[i], "-e") == 0) {
         	execfile[++execfileNum]= argv[++i];
+			execPriority[execfileNum] = 0;
+			cout << execfile[execfileNum] << "\n";
+		} else if (strcmp(argv[i], "-ep") == 0) {
+	    	ASSERT(i + 2 < argc);
+        	execfile[++execfileNum]= argv[i + 1];
+			execPriority[execfileNum] = atoi(argv[i + 2]);
 			cout << execfile[execfileNum] << "\n";
+	    	i += 2;
+		} else if (strcmp(argv[i], "-sched") == 0) {
+	    	ASSERT(i + 1 < argc);
+	    	if (!SchedulingPolicy::ParseType(argv[i + 1], &schedulerType)) {
+				cerr << "Unknown scheduling policy: " << argv[i + 1] << "\n";
+				Abort();
+	    	}
+	    	i++;
+		} else if (strcmp(argv[i], "-pred") == 0) {
+	    	ASSERT(i + 2 < argc);
+	    	if (!BurstPredictor::ParseType(argv[i + 1], &predictorType)) {
+				cerr << "Unknown burst predictor: " << argv[i + 1] << "\n";
+				Abort();
+	    	}
+	    	predictorParameter = atof(argv[i + 2]);
+	    	if (predictorType == ExpAverage
+				&& (predictorParameter < 0 || predictorParameter > 1)) {
+				cerr << "The exponential average needs an alpha "
+				     << "between 0 and 1\n";
+				Abort();
+	    	}
+	    	if (predictorType != ExpAverage
+				&& ((int) predictorParameter < 1
+				    || (int) predictorParameter > MaxBurstHistory)) {
+				cerr << "The burst window must be from 1 to "
+				     << MaxBurstHistory << " bursts\n";
+				Abort();
+	    	}
+	    	i += 2;
+		} else if (strcmp(argv[i], "-tlb") == 0) {
+	    	ASSERT(i + 2 < argc);
+	    	tlbSize = atoi(argv[i + 1]);
+	    	tlbWays = atoi(argv[i + 2]);
+	    	if (tlbWays < 2 || tlbSize < tlbWays
+				|| tlbSize % tlbWays != 0) {
+				cerr << "The TLB needs at least 2 ways, and a "
+				     << "multiple of that many entries\n";
+				Abort();
+	    	}
+	    	i += 2;
+		} else if (strcmp(argv[i], "-rep") == 0) {
+	    	ASSERT(i + 1 < argc);
+	    	if (!ReplacementPolicy::ParseType(argv[i + 1], &replacementType)) {
+				cerr << "Unknown page replacement policy: " << argv[i + 1] << "\n";
+				Abort();
+	    	}
+	    	i++;
+		} else if (strcmp(argv[i], "-adm") == 0) {
+	    	ASSERT(i + 1 < argc);
+	    	if (!AdmissionQueue::ParseType(argv[i + 1], &admissionType)) {
+				cerr << "Unknown admission order: " << argv[i + 1] << "\n";
+				Abort();
+	    	}
+	    	i++;
+		} else if (strcmp(argv[i], "-disk") == 0) {
+	    	ASSERT(i + 1 < argc);
+	    	if (!DiskPolicy::ParseType(argv[i + 1], &diskPolicyType)) {
+				cerr << "Unknown disk scheduling policy: " << argv[i + 1] << "\n";
+				Abort();
+	    	}
+	    	i++;
 		} else if (strcmp(argv[i], "-ci") == 0) {
 	    	ASSERT(i + 1 < argc);
 	    	consoleIn = argv[i + 1];
@@ -76,6 +155,13 @@ Kernel::Kernel(int argc, char **argv)
         } else if (strcmp(argv[i], "-u") == 0) {
             cout << "Partial usage: nachos [-rs randomSeed]\n";
 	   		cout << "Partial usage: nachos [-s]\n";
+            cout << "Partial usage: nachos [-e file] [-ep file priority]\n";
+            cout << "Partial usage: nachos [-sched fifo|rr|sjf|prio|mlfq]\n";
+            cout << "Partial usage: nachos [-pred exp alpha|mean n|median n]\n";
+            cout << "Partial usage: nachos [-tlb size ways]\n";
+            cout << "Partial usage: nachos [-rep fifo|clock|lru]\n";
+            cout << "Partial usage: nachos [-adm fifo|small]\n";
+            cout << "Partial usage: nachos [-disk fcfs|sstf|scan|clook]\n";
             cout << "Partial usage: nachos [-ci consoleIn] [-co consoleOut]\n";
 #ifndef FILESYS_STUB
 	    	cout << "Partial usage: nachos [-nf]\n";
@@ -105,15 +191,27 @@ Kernel::Initialize()
 
     stats = new Statistics();		// collect statistics
     interrupt = new Interrupt;		// start up interrupt handling
-    scheduler = new Scheduler();	// initialize the ready queue
+    scheduler = new Scheduler(schedulerType,	// initialize the ready queue
+		BurstPredictor::Create(predictorType, predictorParameter));
    
     alarm = new Alarm(randomSlice);	// start up time slicing
    
    
     machine = new Machine(debugUserProg);
+    if (tlbSize > 0) {
+	machine->UseTLB(tlbSize, tlbWays);	// translate through a TLB
+    }
+    frameTable = new FrameTable(NumPhysPages,	// all memory is free
+		ReplacementPolicy::Create(replacementType, NumPhysPages));
+    zeroFrame = frameTable->Allocate(NULL, -1);	// never taken away
+    frameTable->Pin(zeroFrame);
+    bzero(&machine->mainMemory[zeroFrame * PageSize], PageSize);
+    swapSpace = new SwapSpace();		// and all swap space
+    pageCache = new PageCache(NumPhysPages);	// no program text cached
+    admissionQueue = new AdmissionQueue(admissionType);	// nobody waiting
     synchConsoleIn = new SynchConsoleInput(consoleIn); // input from stdin
     synchConsoleOut = new SynchConsoleOutput(consoleOut); // output to stdout
-    synchDisk = new SynchDisk();    //
+    synchDisk = new SynchDisk(diskPolicyType);	// no requests waiting
 #ifdef FILESYS_STUB
     fileSystem = new FileSystem();
 #else
@@ -137,6 +235,10 @@ Kernel::~Kernel()
     delete scheduler;
     delete alarm;
     delete machine;
+    delete pageCache;
+    delete admissionQueue;
+    delete frameTable;
+    delete swapSpace;
     delete synchConsoleIn;
     delete synchConsoleOut;
     delete synchDisk;
@@ -158,6 +260,9 @@ Kernel::ThreadSelfTest() {
    SynchList<int> *synchList;
    
    LibSelfTest();		// test library routines
+   TimingWheel::SelfTest();	// test the pending interrupt queue
+   FrameTable::SelfTest();	// test the physical memory allocator
+   PageTable::SelfTest();	// test the sparse page table
    
    currentThread->SelfTest();	// test thread switching
    
@@ -174,6 +279,20 @@ Kernel::ThreadSelfTest() {
 
 }
 
+//----------------------------------------------------------------------
+// Kernel::Benchmark
+//      Measure how fast the kernel's data structures run on the host.
+//	Unlike the self tests, the results are in host time, not ticks --
+//	except for the disk, which is simulated.
+//----------------------------------------------------------------------
+
+void
+Kernel::Benchmark() {
+   LibBenchmark();		// ready queue implementations
+   TimingWheel::Benchmark();	// pending interrupt queues
+   synchDisk->Benchmark();	// disk scheduling policies
+}
+
 //----------------------------------------------------------------------
 // Kernel::ConsoleTest
 //      Test the synchconsole
@@ -264,25 +383,53 @@ void ForkExecute(Thread *t)
     t->space->Execute(t->getName());
 }
 
+//----------------------------------------------------------------------
+// ForkReturn
+// 	Where the child of a Fork starts: in user mode, returning from the
+//	syscall, with the registers Kernel::Fork gave it.
+//----------------------------------------------------------------------
+
+static void
+ForkReturn(Thread *t)
+{
+    t->RestoreUserState();
+    t->space->RestoreState();
+    kernel->machine->Run();
+    ASSERTNOTREACHED();
+}
+
 void Kernel::ExecAll()
 {
 	for (int i=1;i<=execfileNum;i++) {
-		int a = Exec(execfile[i]);
+		int a = Exec(execfile[i], execPriority[i]);
 	}
 	currentThread->Finish();
     //Kernel::Exec();	
 }
 
+//----------------------------------------------------------------------
+// Kernel::Exec
+// 	Start user program "name", at static priority "priority", in a
+//	thread of its own, and return the thread's ID.  If there isn't
+//	enough swap space for it yet, the thread waits in the admission
+//	queue until there is (see AddrSpace::Load).  Returns -1 if every
+//	thread ID is in use.
+//----------------------------------------------------------------------
 
-int Kernel::Exec(char* name)
+int Kernel::Exec(char* name, int priority)
 {
-	t[threadNum] = new Thread(name, threadNum);
-	t[threadNum]->space = new AddrSpace();
-	t[threadNum]->Fork((VoidFunctionPtr) \
-            &ForkExecute, (void *)t[threadNum]);
-	threadNum++;
+	int id = FreeThreadID();
+
+	if (id == -1) {
+	    return -1;
+	}
+	t[id] = new Thread(name, id);
+	t[id]->tsb->priority = priority;
+	t[id]->space = new AddrSpace();
+	t[id]->Fork((VoidFunctionPtr) \
+            &ForkExecute, (void *)t[id]);
 
-	return threadNum-1;
+	return id;
 /*
     cout << "Total threads number is " << execfileNum << endl;
     for (int n=1;n<=execfileNum;n++) {
@@ -309,3 +456,71 @@ int Kernel::Exec(char* name)
 //    Kernel::Run();
 //  cout << "after ThreadedKernel:Run();" << endl;  // unreachable
 }
+
+//----------------------------------------------------------------------
+// Kernel::Fork
+// 	Start a copy of the current user program, in a thread of its own,
+//	with an address space that shares its pages copy-on-write (see
+//	AddrSpace::Fork).  The child has the parent's registers, but comes
+//	out of the syscall with 0.  Returns the child's thread ID, or -1 if
+//	there is no room for it.
+//
+//	The syscall handler has already moved the PC past the syscall, so
+//	the child carries on after it too.
+//----------------------------------------------------------------------
+
+int Kernel::Fork()
+{
+	Thread *child;
+	AddrSpace *space;
+	int id = FreeThreadID();
+
+	if (id == -1) {
+	    return -1;
+	}
+	space = currentThread->space->Fork();
+	if (space == NULL) {
+	    return -1;
+	}
+	child = new Thread(currentThread->getName(), id);
+	t[id] = child;
+	child->tsb->priority = currentThread->tsb->priority;
+	child->space = space;
+	machine->WriteRegister(2, 0);	// the child's result; the
+	child->SaveUserState();		// handler writes ours after
+	child->Fork((VoidFunctionPtr) &ForkReturn, (void *) child);
+
+	return id;
+}
+
+//----------------------------------------------------------------------
+// Kernel::FreeThreadID
+// 	Return the lowest thread ID that isn't in use by a user program,
+//	or -1 if they all are.  ID 0 is the main thread's, and is what
+//	Fork returns to the child, so it is never given out.
+//----------------------------------------------------------------------
+
+int Kernel::FreeThreadID()
+{
+	for (int i = 1; i < MaxUserThreads; i++) {
+	    if (t[i] == NULL) {
+		return i;
+	    }
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------
+// Kernel::ThreadFinished
+// 	"thread" is finishing: if it is a user program's, its ID can be
+//	used again.
+//----------------------------------------------------------------------
+
+void Kernel::ThreadFinished(Thread *thread)
+{
+	int id = thread->getID();
+
+	if (id >= 0 && id < MaxUserThreads && t[id] == thread) {
+	    t[id] = NULL;
+	}
+}
@@ -18,12 +18,21 @@
 #include "alarm.h"
 #include "filesys.h"
 #include "machine.h"
+#include "replacement.h"
+#include "admission.h"
+#include "diskpolicy.h"
 
 class PostOfficeInput;
 class PostOfficeOutput;
 class SynchConsoleInput;
 class SynchConsoleOutput;
 class SynchDisk;
+class FrameTable;
+class SwapSpace;
+class PageCache;
+
+const int MaxUserThreads = 10;	// thread IDs, counting the main thread's;
+				// Exec and Fork reuse finished ones
 
 typedef int OpenFileId;
 
@@ -37,8 +46,11 @@ class Kernel {
 				// from constructor because 
 				// refers to "kernel" as a global
     void ExecAll();
-    int Exec(char* name);
+    int Exec(char* name, int priority = 0);
+    int Fork();			// copy the current user program
+    void ThreadFinished(Thread *thread);	// its thread ID is free again
     void ThreadSelfTest();	// self test of threads and synchronization
+    void Benchmark();		// time kernel data structures on the host
 	
     void ConsoleTest();         // interactive console self test
     void NetworkTest();         // interactive 2-machine network test
@@ -70,15 +82,30 @@ class Kernel {
     PostOfficeOutput *postOfficeOut;
 
     int hostName;               // machine identifier
-// *************** MP2 *************** //
-    int numAvailPhysPage;
-    bool usedPhysPage[NumPhysPages];
-// *************** MP2 *************** //
+    FrameTable *frameTable;	// which frames of physical memory are
+				// in use, and by whom
+    SwapSpace *swapSpace;	// where pages go when memory is full
+    PageCache *pageCache;	// program text shared between processes
+    AdmissionQueue *admissionQueue;	// programs waiting for swap space
+    int zeroFrame;		// a frame of zeroes, mapped read-only for
+				// pages nobody has written yet
   private:
-    Thread* t[10];
+    Thread* t[MaxUserThreads];	// user programs, by thread ID
     char*   execfile[10];
+    int execPriority[10];	// static priority of each program
     int execfileNum;
     int threadNum;
+    int FreeThreadID();		// lowest ID not in "t"; -1 if none
+    SchedulerType schedulerType;	// policy for choosing the next thread
+    PredictorType predictorType;	// how to predict CPU bursts
+    double predictorParameter;	// alpha, or window size
+    int tlbSize;		// entries in the TLB, or 0 to use page
+				// tables
+    int tlbWays;		// TLB set associativity
+    ReplacementType replacementType;	// how to choose a page to push
+				// out of memory
+    AdmissionType admissionType;	// order to let waiting programs in
+    DiskPolicyType diskPolicyType;	// order to serve disk requests in
     bool randomSlice;		// enable pseudo-random time slicing
     bool debugUserProg;         // single step user program
     double reliability;         // likelihood messages are dropped
@@ -7,18 +7,37 @@
 //              -f -cp <unix file> <nachos file>
 //              -p <nachos file> -r <nachos file> -l -D
 //              -n <network reliability> -m <machine id>
-//              -z -K -C -N
+//              -z -K -B -C -N
+//              -e <nachos file> -ep <nachos file> <priority>
+//              -sched <policy> -pred <predictor> <parameter>
+//              -tlb <size> <ways> -rep <policy> -adm <order>
+//              -disk <policy>
 //
 //    -d causes certain debugging messages to be printed (see debug.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
 //    -z prints the copyright message
 //    -s causes user programs to be executed in single-step mode
 //    -x runs a user program
+//    -e runs a user program; may be given more than once
+//    -ep runs a user program at the given static priority
+//    -sched picks the scheduling policy: fifo, rr, sjf (default),
+//	 prio, or mlfq
+//    -pred picks how CPU bursts are predicted: exp <alpha> (default
+//	 exp 0.5), mean <window>, or median <window>
+//    -tlb translates user addresses through a software-loaded TLB of
+//	 <size> entries, <ways>-way set associative, instead of page tables
+//    -rep picks the page replacement policy: fifo, clock (default), or lru
+//    -adm picks the order programs waiting for swap space are let in:
+//	 fifo (default), or small (smallest first)
+//    -disk picks the order waiting disk requests are served in: fcfs
+//	 (default), sstf, scan, or clook
 //    -ci specify file for console input (stdin is the default)
 //    -co specify file for console output (stdout is the default)
 //    -n sets the network reliability
 //    -m sets this machine's host id (needed for the network)
 //    -K run a simple self test of kernel threads and synchronization
+//    -B run benchmarks of kernel data structures (host time), and of
+//	 disk scheduling (simulated time)
 //    -C run an interactive console test
 //    -N run a two-machine network test (see Kernel::NetworkTest)
 //
@@ -45,6 +64,7 @@
 #include "filesys.h"
 #include "openfile.h"
 #include "sysdep.h"
+#include "synchdisk.h"
 
 // global variables
 Kernel *kernel;
@@ -170,6 +190,7 @@ main(int argc, char **argv)
     char *debugArg = "";
     char *userProgName = NULL;        // default is not to execute a user prog
     bool threadTestFlag = false;
+    bool benchmarkFlag = false;
     bool consoleTestFlag = false;
     bool networkTestFlag = false;
 #ifndef FILESYS_STUB
@@ -201,6 +222,9 @@ main(int argc, char **argv)
         else if (strcmp(argv[i], "-K") == 0) {
             threadTestFlag = TRUE;
         }
+        else if (strcmp(argv[i], "-B") == 0) {
+            benchmarkFlag = TRUE;
+        }
         else if (strcmp(argv[i], "-C") == 0) {
             consoleTestFlag = TRUE;
         }
@@ -234,7 +258,7 @@ main(int argc, char **argv)
 	    else if (strcmp(argv[i], "-u") == 0) {
             cout << "Partial usage: nachos [-z -d debugFlags]\n";
             cout << "Partial usage: nachos [-x programName]\n";
-	        cout << "Partial usage: nachos [-K] [-C] [-N]\n";
+	        cout << "Partial usage: nachos [-K] [-B] [-C] [-N]\n";
 #ifndef FILESYS_STUB
             cout << "Partial usage: nachos [-cp UnixFile NachosFile]\n";
             cout << "Partial usage: nachos [-p fileName] [-r fileName]\n";
@@ -257,6 +281,9 @@ main(int argc, char **argv)
     if (threadTestFlag) {
       kernel->ThreadSelfTest();  // test threads and synchronization
     }
+    if (benchmarkFlag) {
+      kernel->Benchmark();       // time kernel data structures
+    }
     if (consoleTestFlag) {
       kernel->ConsoleTest();   // interactive test of the synchronized console
     }
@@ -280,6 +307,7 @@ main(int argc, char **argv)
     if (printFileName != NULL) {
       Print(printFileName);
     }
+    kernel->synchDisk->Flush();	// get the changes out of the disk cache
 #endif // FILESYS_STUB
 
     // finally, run an initial user program if requested to do so
@@ -0,0 +1,268 @@
+// predictor.cc
+//	Routines to predict the length of the next CPU burst of a
+//	thread, and to measure how good those predictions are.
+//
+// 	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "predictor.h"
+#include "main.h"
+
+//----------------------------------------------------------------------
+// PredictionRecord::PredictionRecord
+// 	Start keeping score for a thread.
+//----------------------------------------------------------------------
+
+PredictionRecord::PredictionRecord(char *threadName, int threadID)
+{
+    name = threadName;
+    id = threadID;
+    numPredictions = 0;
+    errorSum = 0;
+    absErrorSum = 0;
+}
+
+//----------------------------------------------------------------------
+// PredictionRecord::Add
+// 	Score one prediction against the burst that actually happened.
+//----------------------------------------------------------------------
+
+void
+PredictionRecord::Add(double predicted, double actual)
+{
+    double error = predicted - actual;
+
+    numPredictions++;
+    errorSum += error;
+    absErrorSum += (error < 0) ? -error : error;
+}
+
+//----------------------------------------------------------------------
+// PredictionRecord::Print
+// 	Print the mean absolute error and bias of the predictions.
+//----------------------------------------------------------------------
+
+void
+PredictionRecord::Print()
+{
+    cout << "predictions " << numPredictions
+	 << ", mean abs error " << absErrorSum / numPredictions
+	 << ", bias " << errorSum / numPredictions << "\n";
+}
+
+//----------------------------------------------------------------------
+// BurstPredictor::BurstPredictor, BurstPredictor::~BurstPredictor
+//----------------------------------------------------------------------
+
+BurstPredictor::BurstPredictor()
+{
+    records = new List<PredictionRecord *>;
+}
+
+BurstPredictor::~BurstPredictor()
+{
+    while (!records->IsEmpty()) {
+	delete records->RemoveFront();
+    }
+    delete records;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictor::Create
+// 	Make a predictor of the given type.  "parameter" is alpha for the
+//	exponential average, and the window size for the others.
+//----------------------------------------------------------------------
+
+BurstPredictor *
+BurstPredictor::Create(PredictorType type, double parameter)
+{
+    switch (type) {
+      case ExpAverage:	 return new ExpAveragePredictor(parameter);
+      case WindowMean:	 return new WindowMeanPredictor((int) parameter);
+      case WindowMedian: return new WindowMedianPredictor((int) parameter);
+    }
+    ASSERTNOTREACHED();
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictor::ParseType
+// 	Convert the name of a predictor, as given to "-pred", into its
+//	type.  Returns FALSE if there is no such predictor.
+//----------------------------------------------------------------------
+
+bool
+BurstPredictor::ParseType(char *name, PredictorType *type)
+{
+    if (strcmp(name, "exp") == 0) {
+	*type = ExpAverage;
+    } else if (strcmp(name, "mean") == 0) {
+	*type = WindowMean;
+    } else if (strcmp(name, "median") == 0) {
+	*type = WindowMedian;
+    } else {
+	return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// BurstPredictor::Update
+// 	"thread" has just finished a CPU burst.  Score the prediction we
+//	made for it, add it to the thread's history, and predict the
+//	next one.  The first burst is not scored, since there was nothing
+//	to base a prediction on.
+//----------------------------------------------------------------------
+
+void
+BurstPredictor::Update(Thread *thread, double burst)
+{
+    ThreadSchedulingBlock *tsb = thread->tsb;
+    double t_pred_prev = tsb->t_pred;
+
+    if (tsb->numBursts > 0) {
+	if (tsb->record == NULL) {
+	    tsb->record = new PredictionRecord(thread->getName(),
+						thread->getID());
+	    records->Append(tsb->record);
+	}
+	tsb->record->Add(tsb->t_pred, burst);
+    }
+    tsb->history[tsb->numBursts % MaxBurstHistory] = burst;
+    tsb->numBursts++;
+    tsb->t_pred = Predict(tsb);
+
+    DEBUG('z', "[C] Tick [" <<  kernel->stats->totalTicks
+                            << "]: Thread ["
+                            << thread->getName() << ", " << thread->getID()
+                            << "] update approximate burst time, from: ["
+                            << t_pred_prev
+                            << "], add ["
+                            << burst
+                            << "], to ["
+                            << tsb->t_pred
+                            << "]"
+                            );
+}
+
+//----------------------------------------------------------------------
+// BurstPredictor::Print
+// 	Report how far off the predictions were for every thread, and
+//	over all threads.  Prints nothing if no prediction was scored;
+//	a thread only gets a record once a prediction for it is scored.
+//----------------------------------------------------------------------
+
+void
+BurstPredictor::Print()
+{
+    ListIterator<PredictionRecord *> *iter;
+    PredictionRecord total("all threads", 0);
+
+    if (records->IsEmpty()) {
+	return;
+    }
+    cout << "Burst prediction (" << getName() << " " << getParameter()
+	 << "):\n";
+    iter = new ListIterator<PredictionRecord *>(records);
+    for (; !iter->IsDone(); iter->Next()) {
+	PredictionRecord *record = iter->Item();
+
+	cout << record->name << " (" << record->id << "): ";
+	record->Print();
+	total.numPredictions += record->numPredictions;
+	total.errorSum += record->errorSum;
+	total.absErrorSum += record->absErrorSum;
+    }
+    delete iter;
+    cout << total.name << ": ";
+    total.Print();
+}
+
+//----------------------------------------------------------------------
+// BurstPredictor::WindowSize
+// 	Return how many of the thread's last "window" bursts we can
+//	look at: no more than it has had, or than we remember.
+//----------------------------------------------------------------------
+
+int
+BurstPredictor::WindowSize(ThreadSchedulingBlock *tsb, int window)
+{
+    return min(window, min(tsb->numBursts, MaxBurstHistory));
+}
+
+//----------------------------------------------------------------------
+// ExpAveragePredictor
+//----------------------------------------------------------------------
+
+ExpAveragePredictor::ExpAveragePredictor(double a)
+{
+    ASSERT(a >= 0 && a <= 1);
+    alpha = a;
+}
+
+double
+ExpAveragePredictor::Predict(ThreadSchedulingBlock *tsb)
+{
+    double burst = tsb->history[(tsb->numBursts - 1) % MaxBurstHistory];
+
+    return alpha * burst + (1 - alpha) * tsb->t_pred;
+}
+
+//----------------------------------------------------------------------
+// WindowMeanPredictor
+//----------------------------------------------------------------------
+
+WindowMeanPredictor::WindowMeanPredictor(int n)
+{
+    ASSERT(n >= 1 && n <= MaxBurstHistory);
+    window = n;
+}
+
+double
+WindowMeanPredictor::Predict(ThreadSchedulingBlock *tsb)
+{
+    int n = WindowSize(tsb, window);
+    double sum = 0;
+
+    for (int i = 1; i <= n; i++) {
+	sum += tsb->history[(tsb->numBursts - i) % MaxBurstHistory];
+    }
+    return sum / n;
+}
+
+//----------------------------------------------------------------------
+// WindowMedianPredictor
+//	The window is small, so just insertion sort a copy of it.
+//----------------------------------------------------------------------
+
+WindowMedianPredictor::WindowMedianPredictor(int n)
+{
+    ASSERT(n >= 1 && n <= MaxBurstHistory);
+    window = n;
+}
+
+double
+WindowMedianPredictor::Predict(ThreadSchedulingBlock *tsb)
+{
+    int n = WindowSize(tsb, window);
+    double sorted[MaxBurstHistory];
+    int i, j;
+
+    for (i = 0; i < n; i++) {
+	double burst = tsb->history[(tsb->numBursts - 1 - i) % MaxBurstHistory];
+
+	for (j = i; j > 0 && sorted[j - 1] > burst; j--) {
+	    sorted[j] = sorted[j - 1];
+	}
+	sorted[j] = burst;
+    }
+    if (n % 2 == 1) {
+	return sorted[n / 2];
+    }
+    return (sorted[n / 2 - 1] + sorted[n / 2]) / 2;
+}
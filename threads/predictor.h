@@ -0,0 +1,134 @@
+// predictor.h
+//	Data structures for predicting the length of a thread's next
+//	CPU burst from the lengths of its past bursts.
+//
+//	The scheduler asks the predictor for a new guess ("t_pred")
+//	every time a thread's burst ends, and the predictor keeps track
+//	of how far off each of its guesses turned out to be, so we can
+//	tell how well it suits the workload.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PREDICTOR_H
+#define PREDICTOR_H
+
+#include "copyright.h"
+#include "list.h"
+#include "thread.h"
+
+// The predictors the kernel can be booted with (see "-pred").
+enum PredictorType { ExpAverage, WindowMean, WindowMedian };
+
+// The following class records how good the predictions for one
+// thread were.  The error of a prediction is the predicted burst minus
+// the actual one, so a positive bias means we guessed too long.
+// It outlives the thread, so it can be reported when Nachos halts.
+
+class PredictionRecord {
+  public:
+    PredictionRecord(char *threadName, int threadID);
+
+    void Add(double predicted, double actual);
+				// score one prediction
+    void Print();		// print mean absolute error and bias
+
+    char *name;			// thread the predictions were for
+    int id;
+    int numPredictions;		// predictions scored so far
+    double errorSum;		// sum of (predicted - actual)
+    double absErrorSum;		// sum of |predicted - actual|
+};
+
+// The following class defines a burst predictor.  Subclasses only
+// have to say how to make a prediction from a thread's history;
+// keeping the history and scoring the predictions is done here.
+//
+// A thread's history is kept in its scheduling block: "history" holds
+// the lengths of its last MaxBurstHistory bursts, as a circular buffer
+// indexed by "numBursts".
+
+class BurstPredictor {
+  public:
+    BurstPredictor();
+    virtual ~BurstPredictor();
+
+    virtual char *getName() = 0;	// for the report
+    virtual double getParameter() = 0;	// alpha, or window size
+
+    void Update(Thread *thread, double burst);
+				// "thread" just finished a burst of
+				// length "burst"; score the last
+				// prediction and make a new one
+    void Print();		// report prediction error of every
+				// thread that has blocked at least twice
+
+    static BurstPredictor *Create(PredictorType type, double parameter);
+				// make a predictor of the given type
+    static bool ParseType(char *name, PredictorType *type);
+				// name given to "-pred" -> predictor type
+
+  protected:
+    virtual double Predict(ThreadSchedulingBlock *tsb) = 0;
+				// predict the next burst; the one that
+				// just ended is already in the history
+    int WindowSize(ThreadSchedulingBlock *tsb, int window);
+				// number of bursts in the last "window"
+				// that we still remember
+
+  private:
+    List<PredictionRecord *> *records;	// every thread that has blocked
+};
+
+// Exponential average: t_pred = alpha * burst + (1 - alpha) * t_pred.
+// With alpha = 0.5 this is the predictor Nachos has always used.
+
+class ExpAveragePredictor : public BurstPredictor {
+  public:
+    ExpAveragePredictor(double a);
+
+    char *getName() { return "exp"; }
+    double getParameter() { return alpha; }
+
+  protected:
+    double Predict(ThreadSchedulingBlock *tsb);
+
+  private:
+    double alpha;		// weight of the most recent burst
+};
+
+// Mean of the last "window" bursts.
+
+class WindowMeanPredictor : public BurstPredictor {
+  public:
+    WindowMeanPredictor(int n);
+
+    char *getName() { return "mean"; }
+    double getParameter() { return window; }
+
+  protected:
+    double Predict(ThreadSchedulingBlock *tsb);
+
+  private:
+    int window;			// how many bursts to average
+};
+
+// Median of the last "window" bursts; unlike the mean, a single very
+// long or very short burst doesn't throw it off.
+
+class WindowMedianPredictor : public BurstPredictor {
+  public:
+    WindowMedianPredictor(int n);
+
+    char *getName() { return "median"; }
+    double getParameter() { return window; }
+
+  protected:
+    double Predict(ThreadSchedulingBlock *tsb);
+
+  private:
+    int window;			// how many bursts to take the median of
+};
+
+#endif // PREDICTOR_H
@@ -0,0 +1,438 @@
+// schedpolicy.cc
+//	Routines for the scheduling policies: FIFO, round robin,
+//	preemptive shortest job first, static priority, and
+//	multilevel feedback queue.
+//
+// 	These routines assume that interrupts are already disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "schedpolicy.h"
+#include "main.h"
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::Create
+// 	Make a scheduling policy of the given type.
+//----------------------------------------------------------------------
+
+SchedulingPolicy *
+SchedulingPolicy::Create(SchedulerType type)
+{
+    switch (type) {
+      case FIFO:	return new FifoPolicy();
+      case RR:		return new RoundRobinPolicy();
+      case SJF:		return new SjfPolicy();
+      case Priority:	return new PriorityPolicy();
+      case MLFQ:	return new MlfqPolicy();
+    }
+    ASSERTNOTREACHED();
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::ParseType
+// 	Convert the name of a policy, as given to "-sched", into its type.
+//	Returns FALSE if there is no such policy.
+//----------------------------------------------------------------------
+
+bool
+SchedulingPolicy::ParseType(char *name, SchedulerType *type)
+{
+    if (strcmp(name, "fifo") == 0) {
+	*type = FIFO;
+    } else if (strcmp(name, "rr") == 0) {
+	*type = RR;
+    } else if (strcmp(name, "sjf") == 0) {
+	*type = SJF;
+    } else if (strcmp(name, "prio") == 0) {
+	*type = Priority;
+    } else if (strcmp(name, "mlfq") == 0) {
+	*type = MLFQ;
+    } else {
+	return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::Dispatched
+// 	Note when "thread" started running, so we can tell how long it
+//	has been on the CPU.
+//----------------------------------------------------------------------
+
+void
+SchedulingPolicy::Dispatched(Thread *thread)
+{
+    thread->tsb->t_start = (double)kernel->stats->totalTicks;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::Preempted
+// 	"thread" had to give up the CPU before its burst was over.
+//	Add the time it just ran to its burst so far.
+//----------------------------------------------------------------------
+
+void
+SchedulingPolicy::Preempted(Thread *thread)
+{
+    ThreadSchedulingBlock *tsb = thread->tsb;
+
+    tsb->T += (double)kernel->stats->totalTicks - tsb->t_start;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::Blocked
+// 	"thread" is waiting for something, so its CPU burst is over.
+//	Return how long the burst was, and start counting a new one.
+//----------------------------------------------------------------------
+
+double
+SchedulingPolicy::Blocked(Thread *thread)
+{
+    ThreadSchedulingBlock *tsb = thread->tsb;
+    double burst = tsb->T + (double)kernel->stats->totalTicks - tsb->t_start;
+
+    tsb->T = 0;
+    return burst;
+}
+
+//----------------------------------------------------------------------
+// SchedulingPolicy::ShouldPreempt, SchedulingPolicy::TimerTick
+// 	By default, a thread keeps the CPU until it blocks.
+//----------------------------------------------------------------------
+
+bool
+SchedulingPolicy::ShouldPreempt(Thread *thread)
+{
+    return FALSE;
+}
+
+bool
+SchedulingPolicy::TimerTick(Thread *thread)
+{
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// FifoPolicy
+// 	Ready threads are kept on a list, in order of arrival.
+//----------------------------------------------------------------------
+
+FifoPolicy::FifoPolicy()
+{
+    readyList = new List<Thread *>;
+}
+
+FifoPolicy::~FifoPolicy()
+{
+    delete readyList;
+}
+
+void
+FifoPolicy::Insert(Thread *thread)
+{
+    readyList->Append(thread);
+}
+
+Thread *
+FifoPolicy::RemoveNext()
+{
+    if (readyList->IsEmpty()) {
+	return NULL;
+    }
+    return readyList->RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// RoundRobinPolicy::TimerTick
+// 	Take the CPU away once the running thread has used up its slice.
+//----------------------------------------------------------------------
+
+bool
+RoundRobinPolicy::TimerTick(Thread *thread)
+{
+    return (kernel->stats->totalTicks - thread->tsb->t_start >= RRQuantum);
+}
+
+//----------------------------------------------------------------------
+// ApplyToThread
+// 	The heap-based policies keep scheduling blocks on their ready
+//	queue, so their Apply needs to go from a block to its thread.
+//----------------------------------------------------------------------
+
+static void (*applyFunc)(Thread *);
+
+static void
+ApplyToThread(ThreadSchedulingBlock *tsb)
+{
+    (*applyFunc)(tsb->thread);
+}
+
+//----------------------------------------------------------------------
+// SjfPolicy
+// 	Ready threads are kept on a heap, sorted by predicted time
+//	remaining in their CPU burst.
+//----------------------------------------------------------------------
+
+SjfPolicy::SjfPolicy()
+{
+    readyList = new Heap<ThreadSchedulingBlock *>\
+                (ThreadSchedulingBlock::Compare, ThreadSchedulingBlock::HeapIndex);
+}
+
+SjfPolicy::~SjfPolicy()
+{
+    delete readyList;
+}
+
+void
+SjfPolicy::Insert(Thread *thread)
+{
+    SetKey(thread->tsb);
+    readyList->Insert(thread->tsb);
+}
+
+Thread *
+SjfPolicy::RemoveNext()
+{
+    if (readyList->IsEmpty()) {
+	return NULL;
+    }
+    return readyList->RemoveFront()->thread;
+}
+
+void
+SjfPolicy::Apply(void (*func)(Thread *))
+{
+    applyFunc = func;
+    readyList->Apply(ApplyToThread);
+}
+
+//----------------------------------------------------------------------
+// SjfPolicy::SetKey
+// 	A thread is sorted by what is left of its predicted burst: all of
+//	it after it blocked, less the time it has run if it was preempted.
+//----------------------------------------------------------------------
+
+void
+SjfPolicy::SetKey(ThreadSchedulingBlock *tsb)
+{
+    tsb->t_key = tsb->t_pred - tsb->T;
+    if(tsb->t_key < 0){ tsb->t_key = 0;}
+}
+
+//----------------------------------------------------------------------
+// SjfPolicy::ShouldPreempt
+// 	Preempt the running thread if the one that woke up is predicted
+//	to finish its burst sooner than what the running one has left.
+//----------------------------------------------------------------------
+
+bool
+SjfPolicy::ShouldPreempt(Thread *thread)
+{
+    ThreadSchedulingBlock *cur = kernel->currentThread->tsb;
+    double t_cur = (double)kernel->stats->totalTicks;
+    double T_cur = t_cur - cur->t_start + cur->T;
+    double t_key_cur = cur->t_pred - T_cur;
+
+    SetKey(thread->tsb);
+    if(thread->tsb->t_key < t_key_cur){
+        DEBUG('z', "[G] Tick [" <<  kernel->stats->totalTicks
+        << "]: Thread ["
+        << thread->getName() << ", " << thread->getID()
+        << "] can preempt cur thrad. cur thread remaining time ["
+        << t_key_cur
+        << "], new ready thread pred time ["
+        << thread->tsb->t_key
+        << "]"
+
+        );
+        return TRUE;
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// PriorityPolicy
+// 	Ready threads are kept on a heap, highest priority first.
+//----------------------------------------------------------------------
+
+static int
+ComparePriority(ThreadSchedulingBlock *x, ThreadSchedulingBlock *y)
+{
+    if (x->priority > y->priority) return -1;
+    else if (x->priority == y->priority) return 0;
+    else return 1;
+}
+
+PriorityPolicy::PriorityPolicy()
+{
+    readyList = new Heap<ThreadSchedulingBlock *>\
+                (ComparePriority, ThreadSchedulingBlock::HeapIndex);
+}
+
+PriorityPolicy::~PriorityPolicy()
+{
+    delete readyList;
+}
+
+void
+PriorityPolicy::Insert(Thread *thread)
+{
+    readyList->Insert(thread->tsb);
+}
+
+Thread *
+PriorityPolicy::RemoveNext()
+{
+    if (readyList->IsEmpty()) {
+	return NULL;
+    }
+    return readyList->RemoveFront()->thread;
+}
+
+void
+PriorityPolicy::Apply(void (*func)(Thread *))
+{
+    applyFunc = func;
+    readyList->Apply(ApplyToThread);
+}
+
+bool
+PriorityPolicy::ShouldPreempt(Thread *thread)
+{
+    return (thread->tsb->priority > kernel->currentThread->tsb->priority);
+}
+
+//----------------------------------------------------------------------
+// MlfqPolicy
+// 	Ready threads are kept on one list per level; "level" in the
+//	scheduling block says which.
+//----------------------------------------------------------------------
+
+MlfqPolicy::MlfqPolicy()
+{
+    for (int i = 0; i < MlfqLevels; i++) {
+	queue[i] = new List<Thread *>;
+    }
+}
+
+MlfqPolicy::~MlfqPolicy()
+{
+    for (int i = 0; i < MlfqLevels; i++) {
+	delete queue[i];
+    }
+}
+
+void
+MlfqPolicy::Insert(Thread *thread)
+{
+    thread->tsb->t_start = (double)kernel->stats->totalTicks;
+    queue[thread->tsb->level]->Append(thread);
+}
+
+Thread *
+MlfqPolicy::RemoveNext()
+{
+    for (int i = 0; i < MlfqLevels; i++) {
+	if (!queue[i]->IsEmpty()) {
+	    return queue[i]->RemoveFront();
+	}
+    }
+    return NULL;
+}
+
+bool
+MlfqPolicy::IsEmpty()
+{
+    for (int i = 0; i < MlfqLevels; i++) {
+	if (!queue[i]->IsEmpty()) {
+	    return FALSE;
+	}
+    }
+    return TRUE;
+}
+
+void
+MlfqPolicy::Apply(void (*func)(Thread *))
+{
+    for (int i = 0; i < MlfqLevels; i++) {
+	queue[i]->Apply(func);
+    }
+}
+
+//----------------------------------------------------------------------
+// MlfqPolicy::ShouldPreempt
+// 	A thread waking up in a higher queue preempts the running one.
+//----------------------------------------------------------------------
+
+bool
+MlfqPolicy::ShouldPreempt(Thread *thread)
+{
+    return (thread->tsb->level < kernel->currentThread->tsb->level);
+}
+
+//----------------------------------------------------------------------
+// MlfqPolicy::Age
+// 	Move every thread that has waited MlfqAgingTicks or more on its
+//	ready queue up one level.  Each queue is in order of arrival, so
+//	only the threads at the front can have waited that long.
+//----------------------------------------------------------------------
+
+void
+MlfqPolicy::Age()
+{
+    double now = (double)kernel->stats->totalTicks;
+
+    for (int i = 1; i < MlfqLevels; i++) {
+	while (!queue[i]->IsEmpty() && 
+		now - queue[i]->Front()->tsb->t_start >= MlfqAgingTicks) {
+	    Thread *thread = queue[i]->RemoveFront();
+
+	    thread->tsb->level = i - 1;
+	    DEBUG('z', "[I] Tick [" <<  kernel->stats->totalTicks
+                      << "]: Thread ["
+                      << thread->getName() << ", " << thread->getID()
+                      << "] waited too long, moves to level ["
+                      << thread->tsb->level << "]");
+	    Insert(thread);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// MlfqPolicy::TimerTick
+// 	Age the ready queues, then decide whether the running thread
+//	should give up the CPU: either it has used up the time slice for
+//	its level, in which case it also moves down a level, or aging
+//	has put a thread on a higher queue than its own.
+//----------------------------------------------------------------------
+
+bool
+MlfqPolicy::TimerTick(Thread *thread)
+{
+    ThreadSchedulingBlock *tsb = thread->tsb;
+
+    Age();
+    if (kernel->stats->totalTicks - tsb->t_start >= MlfqQuantum[tsb->level]) {
+	if (tsb->level < MlfqLevels - 1) {
+	    tsb->level++;
+	    DEBUG('z', "[H] Tick [" <<  kernel->stats->totalTicks
+                      << "]: Thread ["
+                      << thread->getName() << ", " << thread->getID()
+                      << "] used up its time slice, moves to level ["
+                      << tsb->level << "]");
+	}
+	return TRUE;
+    }
+    for (int i = 0; i < tsb->level; i++) {
+	if (!queue[i]->IsEmpty()) {
+	    return TRUE;
+	}
+    }
+    return FALSE;
+}
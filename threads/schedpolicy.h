@@ -0,0 +1,191 @@
+// schedpolicy.h
+//	Data structures for the scheduling policies the dispatcher can
+//	use to pick the next thread to run.
+//
+//	A scheduling policy owns the ready queue, and is told about the
+//	events in the life of a CPU burst: a thread being dispatched,
+//	preempted, blocking, or waking up, and the timer going off while
+//	it runs.  The Scheduler does the actual context switching, so a
+//	policy only has to decide who goes next, and when to preempt.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPOLICY_H
+#define SCHEDPOLICY_H
+
+#include "copyright.h"
+#include "list.h"
+#include "heap.h"
+#include "thread.h"
+
+// The policies the kernel can be booted with (see "-sched").
+enum SchedulerType { FIFO, RR, SJF, Priority, MLFQ };
+
+// Time slice for round robin.  Slices are only checked when the timer
+// goes off, so they are in effect rounded up to a multiple of TimerTicks.
+const int RRQuantum = 100;
+
+// Multilevel feedback queue parameters.  New threads start in queue 0,
+// the one that runs first; each level further down gets a longer time
+// slice.  A thread that has waited MlfqAgingTicks on a ready queue
+// without running moves up a level, so nothing waits forever.
+const int MlfqLevels = 3;
+const int MlfqQuantum[MlfqLevels] = { 100, 200, 400 };
+const int MlfqAgingTicks = 2000;
+
+// The following class defines the interface every scheduling policy
+// provides.  All routines are called with interrupts disabled.
+//
+// The default event handlers keep track of how long the running thread
+// has been on the CPU: "t_start" is when it was last dispatched, and "T"
+// is how long it has run so far in its current CPU burst.
+
+class SchedulingPolicy {
+  public:
+    SchedulingPolicy() {};
+    virtual ~SchedulingPolicy() {};
+
+    virtual char *getName() = 0;	// for debugging
+
+    virtual void Insert(Thread *thread) = 0;
+				// put a thread on the ready queue
+    virtual Thread *RemoveNext() = 0;
+				// take the thread to run next off the
+				// ready queue; NULL if there are none
+    virtual bool IsEmpty() = 0;	// is the ready queue empty?
+    virtual void Apply(void (*func)(Thread *)) = 0;
+				// apply function to all ready threads
+
+    virtual void Dispatched(Thread *thread);
+				// thread is about to run
+    virtual void Preempted(Thread *thread);
+				// thread lost the CPU, but is still ready
+    virtual double Blocked(Thread *thread);
+				// thread is giving up the CPU to wait;
+				// returns the length of the burst
+    virtual bool ShouldPreempt(Thread *thread);
+				// thread just woke up; should it take
+				// the CPU from the running thread?
+    virtual bool TimerTick(Thread *thread);
+				// the timer went off while thread was
+				// running; should it give up the CPU?
+
+    static SchedulingPolicy *Create(SchedulerType type);
+				// make a policy of the given type
+    static bool ParseType(char *name, SchedulerType *type);
+				// name given to "-sched" -> policy type
+};
+
+// First come, first served: threads run until they block.
+
+class FifoPolicy : public SchedulingPolicy {
+  public:
+    FifoPolicy();
+    ~FifoPolicy();
+
+    char *getName() { return "fifo"; }
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool IsEmpty() { return readyList->IsEmpty(); }
+    void Apply(void (*func)(Thread *)) { readyList->Apply(func); }
+
+  private:
+    List<Thread *> *readyList;	// threads in order of arrival
+};
+
+// Round robin: FIFO, but a thread gives up the CPU when its time slice
+// runs out.
+
+class RoundRobinPolicy : public FifoPolicy {
+  public:
+    char *getName() { return "rr"; }
+
+    bool TimerTick(Thread *thread);
+};
+
+// Preemptive shortest job first: the thread with the shortest predicted
+// remaining CPU burst runs first, and a thread that wakes up preempts
+// the running one if it is predicted to finish sooner.  The prediction
+// ("t_pred") is made by the scheduler's BurstPredictor; the ready
+// queue is sorted by predicted time remaining ("t_key").
+
+class SjfPolicy : public SchedulingPolicy {
+  public:
+    SjfPolicy();
+    ~SjfPolicy();
+
+    char *getName() { return "sjf"; }
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool IsEmpty() { return readyList->IsEmpty(); }
+    void Apply(void (*func)(Thread *));
+
+    bool ShouldPreempt(Thread *thread);
+
+  private:
+    Heap<ThreadSchedulingBlock *> *readyList;
+				// shortest predicted remaining time first
+    void SetKey(ThreadSchedulingBlock *tsb);
+				// t_key = what's left of t_pred
+};
+
+// Static priority: the ready thread with the highest "priority" runs
+// first, and preempts a running thread of lower priority when it wakes
+// up.  Threads of equal priority run in FIFO order.
+
+class PriorityPolicy : public SchedulingPolicy {
+  public:
+    PriorityPolicy();
+    ~PriorityPolicy();
+
+    char *getName() { return "prio"; }
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool IsEmpty() { return readyList->IsEmpty(); }
+    void Apply(void (*func)(Thread *));
+
+    bool ShouldPreempt(Thread *thread);
+
+  private:
+    Heap<ThreadSchedulingBlock *> *readyList;
+				// highest priority first
+};
+
+// Multilevel feedback queue: one FIFO queue per level, and threads in
+// a higher queue (lower "level") always run first.  A thread that uses
+// up its time slice moves down a level, so CPU-bound threads sink
+// below interactive ones; a thread that waits too long on its queue
+// moves back up (aging), so they don't starve.
+//
+// While a thread is on a ready queue it is not running, so "t_start"
+// records when it joined the queue instead; Dispatched sets it back to
+// the time the thread starts running.
+
+class MlfqPolicy : public SchedulingPolicy {
+  public:
+    MlfqPolicy();
+    ~MlfqPolicy();
+
+    char *getName() { return "mlfq"; }
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool IsEmpty();
+    void Apply(void (*func)(Thread *));
+
+    bool ShouldPreempt(Thread *thread);
+    bool TimerTick(Thread *thread);
+
+  private:
+    List<Thread *> *queue[MlfqLevels];	// ready threads at each level,
+					// in the order they joined it
+    void Age();				// move up threads that waited
+					// too long
+};
+
+#endif // SCHEDPOLICY_H
@@ -11,8 +11,8 @@
 //	end up calling FindNextToRun(), and that would put us in an 
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	The order in which ready threads run is decided by a
+//	SchedulingPolicy, chosen when the kernel boots.
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -27,12 +27,16 @@
 // Scheduler::Scheduler
 // 	Initialize the list of ready but not running threads.
 //	Initially, no ready threads.
+//
+//	"type" is the scheduling policy to use.
+//	"burstPredictor" predicts CPU burst lengths; the scheduler
+//		deletes it when done.
 //----------------------------------------------------------------------
 
-Scheduler::Scheduler()
+Scheduler::Scheduler(SchedulerType type, BurstPredictor *burstPredictor)
 { 
-    readyList = new SortedList<ThreadSchedulingBlock *>\
-                (ThreadSchedulingBlock::Compare); 
+    policy = SchedulingPolicy::Create(type);
+    predictor = burstPredictor;
     toBeDestroyed = NULL;
     preempt = FALSE;
 } 
@@ -44,39 +48,26 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 { 
-    delete readyList; 
+    delete policy; 
+    delete predictor;
 } 
 
 
 
 
 
+//----------------------------------------------------------------------
+// Scheduler::CheckPreempt
+// 	"thread" has just woken up.  If the policy says it should run
+//	instead of the current thread, arrange for a preemption.
+//----------------------------------------------------------------------
+
 void Scheduler::CheckPreempt(Thread *thread){
 
     MachineStatus status = kernel->interrupt->getStatus();
 
-    if (status != IdleMode) { 
-                              
-        double t_cur = (double)kernel->stats->totalTicks;
-        double T_cur = t_cur - kernel->currentThread->tsb->t_start + \
-                                        kernel->currentThread->tsb->T;
-        double t_key_cur = kernel->currentThread->tsb->t_pred - T_cur;
-
-        if(thread->tsb->t_key < t_key_cur){
-            DEBUG('z', "[G] Tick [" <<  kernel->stats->totalTicks
-            << "]: Thread [" 
-            << thread->getName() << ", " << thread->getID()
-            << "] can preempt cur thrad. cur thread remaining time ["
-            << t_key_cur
-            << "], new ready thread pred time ["
-            << thread->tsb->t_key
-            << "]"
-            
-            );   
-
-            Preempt();
-
-        }
+    if (status != IdleMode && policy->ShouldPreempt(thread)) { 
+        Preempt();
     }
 }
 
@@ -87,6 +78,43 @@ Scheduler::Preempt()
     preempt = TRUE; 
 }
 
+//----------------------------------------------------------------------
+// Scheduler::Preempted, Scheduler::Blocked
+// 	The running thread is giving up the CPU, either because it was
+//	preempted, or because it is going to sleep.  Let the policy
+//	account for the time it ran.  If its burst is over, predict
+//	how long the next one will be.
+//----------------------------------------------------------------------
+
+void
+Scheduler::Preempted(Thread *thread)
+{
+    policy->Preempted(thread);
+}
+
+double
+Scheduler::Blocked(Thread *thread)
+{
+    double burst = policy->Blocked(thread);
+
+    predictor->Update(thread, burst);
+    return burst;
+}
+
+//----------------------------------------------------------------------
+// Scheduler::TimerTick
+// 	Called from the timer interrupt handler.  If the policy says the
+//	running thread's time is up, arrange for a preemption.
+//----------------------------------------------------------------------
+
+void
+Scheduler::TimerTick()
+{
+    if (policy->TimerTick(kernel->currentThread)) {
+        Preempt();
+    }
+}
+
 
 
 void
@@ -104,7 +132,7 @@ Scheduler::ReadyToRun(Thread *thread)
                             << "] is inserted into queue");
 
     thread->setStatus(READY);
-    readyList->Insert(thread->tsb);
+    policy->Insert(thread);
 }
 
 
@@ -115,12 +143,12 @@ Scheduler::FindNextToRun()
     static int counter = 0;
     counter++;
     ASSERT(kernel->interrupt->getLevel() == IntOff);
-    if (readyList->IsEmpty()) {
+    Thread *nextThread = policy->RemoveNext();
+    if (nextThread == NULL) {
 		return NULL;
     } else {
 
-        Thread *nextThread =  readyList->RemoveFront()->thread;
-        nextThread->tsb->t_start = (double)kernel->stats->totalTicks;
+        policy->Dispatched(nextThread);
 
         DEBUG('z', "[B] Tick [" <<  kernel->stats->totalTicks
                   << "]: Thread [" 
@@ -175,6 +203,18 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 
 }
 
+//----------------------------------------------------------------------
+// Scheduler::PrintPredictions
+// 	Report how far off the burst predictions were.  Called when
+//	Nachos halts.
+//----------------------------------------------------------------------
+
+void
+Scheduler::PrintPredictions()
+{
+    predictor->Print();
+}
+
 //----------------------------------------------------------------------
 // Scheduler::CheckToBeDestroyed
 // 	If the old thread gave up the processor because it was finishing,
@@ -200,7 +240,6 @@ Scheduler::CheckToBeDestroyed()
 void
 Scheduler::Print()
 {
-    // cout << "Ready list contents:\n";
-    // readyList->Apply(ThreadPrint);
-    cout << "[Scheduler::Print()] Not implemented\n";
+    cout << "Ready list contents (" << policy->getName() << "):\n";
+    policy->Apply(ThreadPrint);
 }
@@ -10,18 +10,23 @@
 #define SCHEDULER_H
 
 #include "copyright.h"
-#include "list.h"
 #include "thread.h"
+#include "schedpolicy.h"
+#include "predictor.h"
 
 // The following class defines the scheduler/dispatcher abstraction -- 
 // the data structures and operations needed to keep track of which 
 // thread is running, and which threads are ready but not running.
+// Which ready thread runs next, and when the running thread is
+// preempted, is up to the scheduling policy.  The length of each
+// thread's next CPU burst is guessed by the burst predictor.
 
 
 
 class Scheduler {
   public:
-    Scheduler();		// Initialize list of ready threads 
+    Scheduler(SchedulerType type, BurstPredictor *burstPredictor);
+    				// Initialize list of ready threads 
     ~Scheduler();		// De-allocate ready list
 
     void ReadyToRun(Thread* thread);	
@@ -34,7 +39,17 @@ class Scheduler {
     				// running needs to be deleted
     void Print();		// Print contents of ready list
     void CheckPreempt(Thread *thread);
-    void Preempt();
+    				// thread woke up; preempt the
+				// running thread if the policy says so
+    void Preempt();		// make the running thread yield at
+				// the next timer interrupt
+    void Preempted(Thread *thread);
+    				// thread is yielding the CPU
+    double Blocked(Thread *thread);
+    				// thread is going to sleep; returns
+				// the length of its CPU burst
+    void TimerTick();		// called on every timer interrupt
+    void PrintPredictions();	// report how good burst predictions were
     
     // SelfTest for scheduler is implemented in class Thread
 
@@ -43,8 +58,9 @@ class Scheduler {
   private:
     
   
-    SortedList<ThreadSchedulingBlock *> *readyList;  // queue of threads that are ready to run,
+    SchedulingPolicy *policy;	// queue of threads that are ready to run,
 				// but not running
+    BurstPredictor *predictor;	// guesses how long bursts will be
     Thread *toBeDestroyed;	// finishing thread to be destroyed
     				// by the next thread that runs
 };
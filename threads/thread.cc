@@ -54,6 +54,11 @@ Thread::Thread(char* threadName, int threadID)
     tsb->t_pred = 0;
     tsb->t_key = 0;
     tsb->T = 0;
+    tsb->heapIndex = -1;
+    tsb->priority = 0;
+    tsb->level = 0;
+    tsb->numBursts = 0;
+    tsb->record = NULL;
 }
 
 //----------------------------------------------------------------------
@@ -166,7 +171,12 @@ Thread::Begin ()
 void
 Thread::Finish ()
 {
-    (void) kernel->interrupt->SetLevel(IntOff);		
+    if (space != NULL) {	// give its memory and swap pages back,
+	delete space;		// while we can still wait for the disk
+	space = NULL;
+    }
+    kernel->ThreadFinished(this);	// nobody can look it up after this
+    (void) kernel->interrupt->SetLevel(IntOff);
     ASSERT(this == kernel->currentThread);
     Sleep(TRUE);				// invokes SWITCH
 }
@@ -201,12 +211,8 @@ Thread::Yield() // preemption
     
     IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
     ASSERT(this == kernel->currentThread);
-    double t_cur = (double)kernel->stats->totalTicks;
     ThreadSchedulingBlock *tsb = this->tsb;
-    tsb->T += t_cur - tsb->t_start;
-
-    tsb->t_key = tsb->t_pred - tsb->T;
-    if(tsb->t_key < 0){ tsb->t_key = 0;}
+    kernel->scheduler->Preempted(this);
 
     kernel->scheduler->ReadyToRun(this);
     Thread *nextThread = kernel->scheduler->FindNextToRun();
@@ -249,27 +255,8 @@ Thread::Sleep(bool finishing)
     ASSERT(this == kernel->currentThread);
     ASSERT(kernel->interrupt->getLevel() == IntOff);
     double t_accu;
-    double t_pred_prev;
     if(!finishing){
-        double t_cur = (double)kernel->stats->totalTicks;
-        ThreadSchedulingBlock *tsb = this->tsb;
-        tsb->T += t_cur - tsb->t_start;
-        t_accu = tsb->T;
-        t_pred_prev = tsb->t_pred;
-        tsb->t_pred = 0.5 * tsb->T + 0.5 * tsb->t_pred;
-        tsb->t_key = tsb->t_pred;
-        tsb->T = 0;
-        DEBUG('z', "[C] Tick [" <<  kernel->stats->totalTicks
-                                << "]: Thread [" 
-                                << this->getName() << ", " << this->getID()
-                                << "] update approximate burst time, from: ["
-                                << t_pred_prev
-                                << "], add ["
-                                << t_accu
-                                << "], to ["
-                                << tsb->t_pred
-                                << "]"
-                                );
+        t_accu = kernel->scheduler->Blocked(this);
     }
     Thread *nextThread;
     status = BLOCKED;
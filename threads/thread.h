@@ -74,6 +74,10 @@ enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED, ZOMBIE };
 //  that only run in the kernel have a NULL address space.
 
 class Thread;
+class PredictionRecord;
+
+// Number of past CPU burst lengths remembered for predicting the next.
+const int MaxBurstHistory = 16;
 
 struct ThreadSchedulingBlock{
   double t_pred;
@@ -88,6 +92,10 @@ struct ThreadSchedulingBlock{
       else if(tsb1->t_key > tsb2->t_key) return 1; 
   }
 
+  static int *HeapIndex(ThreadSchedulingBlock *tsb){
+      return &tsb->heapIndex;
+  }
+
   void print(){
       cout << "\nt_pred: " << t_pred << "\n";
       cout << "t_key: " << t_key << "\n";
@@ -96,6 +104,12 @@ struct ThreadSchedulingBlock{
   }
 
   Thread *thread;
+  int heapIndex;	// position in the ready queue, -1 if not on it
+  int priority;		// static priority, higher runs first
+  int level;		// multilevel feedback queue level, 0 runs first
+  double history[MaxBurstHistory];	// lengths of the last few bursts
+  int numBursts;	// bursts completed so far
+  PredictionRecord *record;	// how good the predictions were
 };
 
 
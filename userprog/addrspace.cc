@@ -19,7 +19,11 @@
 #include "main.h"
 #include "addrspace.h"
 #include "machine.h"
-#include "noff.h"
+#include "frametable.h"
+#include "swapspace.h"
+#include "pagecache.h"
+#include "pagetable.h"
+#include "admission.h"
 
 //----------------------------------------------------------------------
 // SwapHeader
@@ -57,6 +61,9 @@ SwapHeader (NoffHeader *noffH)
 #endif
 }
 
+int AddrSpace::lastASID = NumASIDs - 1;
+AddrSpace *AddrSpace::asidOwner[NumASIDs];
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
@@ -67,16 +74,18 @@ SwapHeader (NoffHeader *noffH)
 
 AddrSpace::AddrSpace()
 {
-    pageTable = new TranslationEntry[NumPhysPages];
-    for (int i = 0; i < NumPhysPages; i++) {
-        pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
 // *************** MP2 *************** //
-        pageTable[i].physicalPage = -1;
-        pageTable[i].valid = FALSE;
-        pageTable[i].use = FALSE;
-        pageTable[i].dirty = FALSE;
-        pageTable[i].readOnly = FALSE;  
-    }
+    pageTable = new PageTable;		// Load fills it in, once it knows
+    numPages = 0;			// how big the program is
+    executable = NULL;
+    execName = NULL;
+    execID = -1;
+    numTextPages = 0;
+    firstZeroPage = 0;
+    mapStart = nextMapPage = 0;
+    stackStart = 0;
+    mappings = new List<MappedFile *>;
+    asid = 0;				// none yet: see NewASID
     // zero out the entire address space
     // bzero(kernel->machine->mainMemory, MemorySize);
 // *************** MP2 *************** //
@@ -89,23 +98,64 @@ AddrSpace::AddrSpace()
 
 AddrSpace::~AddrSpace()
 {
+    while (!mappings->IsEmpty()) {	// write them back
+	Munmap(mappings->Front()->firstPage * PageSize);
+    }
 // *************** MP2 *************** //
-    for(int i = 0; i < NumPhysPages; i++){
-        if(pageTable[i].physicalPage == -1) continue;
-        kernel->usedPhysPage[pageTable[i].physicalPage] = FALSE;
-        kernel->numAvailPhysPage++;
+    for (PageTableIterator iter(pageTable); !iter.IsDone(); iter.Next()) {
+        PageEntry *page = iter.Item();
+        int frame = page->translation.physicalPage;
+
+	if (page->swapPage != -1) {
+	    kernel->swapSpace->Free(page->swapPage);
+	}
+        if(frame == -1) continue;
+	if (frame == kernel->zeroFrame) continue;
+	if (kernel->frameTable->Info(frame)->shared) {
+	    kernel->pageCache->Release(this, frame);
+	    continue;
+	}
+	if (kernel->frameTable->Info(frame)->sharers != NULL) {
+	    kernel->frameTable->Unshare(frame, this);
+	    continue;
+	}
+        kernel->frameTable->Free(frame);
     }
 // *************** MP2 *************** //
+    if (asidOwner[asid] == this) {
+	asidOwner[asid] = NULL;		// nobody to save TLB bits for
+    }
     delete pageTable;
+    delete executable;
+    delete [] execName;
+    delete mappings;
+    kernel->admissionQueue->Release();	// room for somebody waiting?
 }
 
 
 //----------------------------------------------------------------------
 // AddrSpace::Load
-// 	Load a user program into memory from a file.
+// 	Get ready to run a user program from a file.
+//
+//	Nothing is read into memory yet: every page starts out invalid,
+//	and is loaded from the file the first time the program touches
+//	it (see PageFault).  We just set up the page table, keep the file
+//	open to load the pages from, and set aside a page of swap space
+//	for every virtual page, so that there is always somewhere to push
+//	a page out to when memory runs short (see PageOut).  If there
+//	isn't enough swap space free, we wait in the kernel's admission
+//	queue until programs that finish give some back.
+//
+//	The program goes at the bottom of user space, and the stack at the
+//	top; the page table only has entries for their pages.
+//
+//	The pages at the start that hold nothing but code and read-only
+//	data are the same for everyone running the program, so they come
+//	from the kernel's page cache (see pagecache.h).  The pages after
+//	the last one with anything from the file on it -- the rest of the
+//	uninitialized data, and the stack -- are zero-fill-on-demand.
 //
-//	Assumes that the page table has been initialized, and that
-//	the object code file is in NOFF format.
+//	Assumes that the object code file is in NOFF format.
 //
 //	"fileName" is the file containing the object code to load into memory
 //----------------------------------------------------------------------
@@ -113,14 +163,17 @@ AddrSpace::~AddrSpace()
 bool 
 AddrSpace::Load(char *fileName) 
 {
-    OpenFile *executable = kernel->fileSystem->Open(fileName);
-    NoffHeader noffH;
     unsigned int size;
+    int textEnd, fileEnd;
+    IntStatus oldLevel;
 
+    executable = kernel->fileSystem->Open(fileName);
     if (executable == NULL) {
         cerr << "Unable to open file " << fileName << "\n";
         return FALSE;
     }
+    execName = new char[strlen(fileName) + 1];
+    strcpy(execName, fileName);
 
     executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
     if ((noffH.noffMagic != NOFFMAGIC) && 
@@ -129,171 +182,677 @@ AddrSpace::Load(char *fileName)
     ASSERT(noffH.noffMagic == NOFFMAGIC);
 
 #ifdef RDATA
-// how big is address space?
+// how big is the program?
     size = noffH.code.size + noffH.readonlyData.size + noffH.initData.size +
-           noffH.uninitData.size + UserStackSize;	
-                                                // we need to increase the size
-						// to leave room for the stack
+           noffH.uninitData.size;
 #else
-// how big is address space?
-    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
-			+ UserStackSize;	// we need to increase the size
-						// to leave room for the stack
+// how big is the program?
+    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size;
 #endif
-    numPages = divRoundUp(size, PageSize);
+    mapStart = nextMapPage = divRoundUp(size, PageSize);
+    stackStart = UserStackTop / PageSize - divRoundUp(UserStackSize, PageSize);
+    numPages = mapStart + divRoundUp(UserStackSize, PageSize);
     size = numPages * PageSize;
 
+    // the text ends where the code and read-only data do, or where
+    // the first writable segment starts, if that is before
+    textEnd = noffH.code.virtualAddr + noffH.code.size;
+#ifdef RDATA
+    if (noffH.readonlyData.size > 0) {
+	textEnd = max(textEnd,
+		noffH.readonlyData.virtualAddr + noffH.readonlyData.size);
+    }
+#endif
+    if (noffH.initData.size > 0) {
+	textEnd = min(textEnd, noffH.initData.virtualAddr);
+    }
+    if (noffH.uninitData.size > 0) {
+	textEnd = min(textEnd, noffH.uninitData.virtualAddr);
+    }
+    numTextPages = textEnd / PageSize;
+
+    // everything after the last segment that comes from the file
+    fileEnd = noffH.code.virtualAddr + noffH.code.size;
+#ifdef RDATA
+    if (noffH.readonlyData.size > 0) {
+	fileEnd = max(fileEnd,
+		noffH.readonlyData.virtualAddr + noffH.readonlyData.size);
+    }
+#endif
+    if (noffH.initData.size > 0) {
+	fileEnd = max(fileEnd, noffH.initData.virtualAddr + noffH.initData.size);
+    }
+    firstZeroPage = divRoundUp(fileEnd, PageSize);
+    execID = kernel->pageCache->ExecutableID(fileName);
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);	// until we have
+							// the swap pages
 // *************** MP2 *************** //
-    // ASSERT(numPages <= NumPhysPages);		// check we're not trying
-						// to run anything too big --
-						// at least until we have
-						// virtual memory
-    if(numPages > kernel->numAvailPhysPage){
+    if(!kernel->admissionQueue->Admit(numPages)){
+        (void) kernel->interrupt->SetLevel(oldLevel);
         kernel->machine->RaiseException(MemoryLimitException, 0);
         return FALSE;
     }
-    int idx = 0;
-    for(int i = 0; i < numPages; i++){
-        while(idx<NumPhysPages && kernel->usedPhysPage[idx]) idx++;
-        ASSERT(kernel->usedPhysPage[idx] == FALSE);
-        pageTable[i].physicalPage = idx;
-        pageTable[i].valid = TRUE;
-        pageTable[i].use = FALSE;
-        pageTable[i].dirty = FALSE;
-        pageTable[i].readOnly = FALSE;
-        kernel->usedPhysPage[idx] = TRUE;
-        kernel->numAvailPhysPage--;
-        bzero(&kernel->machine->mainMemory[idx*PageSize], PageSize);
-    }
 // *************** MP2 *************** //
+    for (unsigned int vpn = 0; vpn < mapStart; vpn++) {
+	pageTable->Add(vpn)->swapPage = kernel->swapSpace->Allocate();
+    }
+    for (unsigned int vpn = stackStart; vpn < UserStackTop / PageSize; vpn++) {
+	pageTable->Add(vpn)->swapPage = kernel->swapSpace->Allocate();
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
 
     DEBUG(dbgAddr, "Initializing address space: " << numPages << ", " << size);
+    return TRUE;			// success
+}
 
-// then, copy in the code and data segments into memory
-// Note: this code assumes that virtual address = physical address
-    if (noffH.code.size > 0) {
-        DEBUG(dbgAddr, "Initializing code segment.");
-	    DEBUG(dbgAddr, noffH.code.virtualAddr << ", " << noffH.code.size);
-// *************** MP2 *************** //
-        // For multiple pages
-        if(!LoadData(noffH.code.virtualAddr, noffH.code.inFileAddr, noffH.code.size, 
-            executable, 1)) 
-            return FALSE;
-        // For only one page
-        // unsigned int physicalAddr;
-        // ExceptionType exception = Translate(noffH.code.virtualAddr, &physicalAddr, 1);
-        // if(exception != NoException){
-        //     kernel->machine->RaiseException(exception, 0);
-        //     return FALSE;
-        // }
-        // executable->ReadAt(
-		// &(kernel->machine->mainMemory[physicalAddr]), 
-		// 	noffH.code.size, noffH.code.inFileAddr);
-// *************** MP2 *************** //
+//----------------------------------------------------------------------
+// AddrSpace::PageFault
+// 	The program touched virtual address "virtAddr", whose page isn't
+//	in memory.  Give the page a frame, and fill it in: from the swap
+//	space if it was dirty when it was pushed out, and otherwise from
+//	the program's file -- whatever parts of the code and data segments
+//	are on the page, and zeroes for the rest.
+//
+//	A text page may be in the page cache already, because another
+//	address space running the same program has read it; then we just
+//	map the same frame, read-only.  Otherwise we read it, and put it
+//	in the cache for the next one.
+//
+//	A page with nothing from the file on it, that has never been
+//	written, is all zeroes; until the program writes it, it shares the
+//	kernel's zero frame, read-only (see WriteFault).  A page that is
+//	written first faults twice, but one that is only read never takes
+//	a frame.
+//
+//	A page of a mapped file is read from the file.
+//
+//	Reading the swap space, or pushing another page out to make room,
+//	may block us until the disk is done.
+//
+//	Returns FALSE if the address isn't in our address space, or its
+//	page is already in memory, so this is some other kind of fault.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageFault(int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    PageEntry *page = pageTable->Find(vpn);
+    TranslationEntry *pte;
+    MappedFile *mapping;
+    int frame;
+
+    if (page == NULL || page->translation.valid) {
+	return FALSE;
     }
-    if (noffH.initData.size > 0) {
-        DEBUG(dbgAddr, "Initializing data segment.");
-	    DEBUG(dbgAddr, noffH.initData.virtualAddr << ", " << noffH.initData.size);
-// *************** MP2 *************** //
-        // For multiple pages
-        if(!LoadData(noffH.initData.virtualAddr, noffH.initData.inFileAddr, noffH.initData.size, 
-            executable, 1)) 
-            return FALSE;
-        // For only one page
-        // unsigned int physicalAddr;
-        // ExceptionType exception = Translate(noffH.initData.virtualAddr, &physicalAddr, 1);
-        // if(exception != NoException){
-        //     kernel->machine->RaiseException(exception, 0);
-        //     return FALSE;
-        // }
-        // executable->ReadAt(
-		// &(kernel->machine->mainMemory[physicalAddr]),
-		// 	noffH.initData.size, noffH.initData.inFileAddr);
-// *************** MP2 *************** //
+    mapping = MappingOf(vpn);
+    kernel->stats->numPageFaults++;
+    if (vpn < numTextPages) {
+	frame = kernel->pageCache->Share(this, execID, vpn);
+	if (frame == -1) {
+	    frame = TakeFrame(vpn);
+	    bzero(&kernel->machine->mainMemory[frame * PageSize], PageSize);
+	    LoadSegment(&noffH.code, vpn, frame);
+#ifdef RDATA
+	    LoadSegment(&noffH.readonlyData, vpn, frame);
+#endif
+	    kernel->machine->InvalidateCode(frame);
+	    kernel->frameTable->Unpin(frame);
+	    frame = kernel->pageCache->Add(this, execID, vpn, frame);
+	}
+	pte = &page->translation;
+	pte->physicalPage = frame;
+	pte->use = FALSE;
+	pte->dirty = FALSE;
+	pte->readOnly = TRUE;
+	pte->valid = TRUE;
+	DEBUG(dbgAddr, "Page fault: text page " << vpn << " in frame "
+		<< frame);
+	return TRUE;
+    }
+    if (vpn >= firstZeroPage && !page->inSwap && mapping == NULL) {
+	pte = &page->translation;
+	pte->physicalPage = kernel->zeroFrame;
+	pte->use = FALSE;
+	pte->dirty = FALSE;
+	pte->readOnly = TRUE;
+	pte->valid = TRUE;
+	DEBUG(dbgAddr, "Page fault: virtual page " << vpn << " maps zeroes");
+	return TRUE;
     }
+    frame = TakeFrame(vpn);		// pinned while we read it in
+    if (mapping != NULL) {
+	int offset = (vpn - mapping->firstPage) * PageSize;
 
+	bzero(&kernel->machine->mainMemory[frame * PageSize], PageSize);
+	mapping->file->ReadAt(&kernel->machine->mainMemory[frame * PageSize],
+		min(PageSize, mapping->length - offset), offset);
+    } else if (page->inSwap) {
+	kernel->swapSpace->ReadPage(page->swapPage, frame);
+    } else {
+	bzero(&kernel->machine->mainMemory[frame * PageSize], PageSize);
+	LoadSegment(&noffH.code, vpn, frame);
+	LoadSegment(&noffH.initData, vpn, frame);
 #ifdef RDATA
-    if (noffH.readonlyData.size > 0) {
-        DEBUG(dbgAddr, "Initializing read only data segment.");
-	    DEBUG(dbgAddr, noffH.readonlyData.virtualAddr << ", " << noffH.readonlyData.size);
-// *************** MP2 *************** //
-        // For multiple pages
-        if(!LoadData(noffH.readonlyData.virtualAddr, noffH.readonlyData.inFileAddr, noffH.readonlyData.size, 
-            executable, 0)) 
-            return FALSE;
-        // For only one page
-        // unsigned int physicalAddr;
-        // ExceptionType exception = Translate(noffH.readonlyData.virtualAddr, &physicalAddr, 0);
-        // if(exception != NoException){
-        //     kernel->machine->RaiseException(exception, 0);
-        //     return FALSE;
-        // }
-        // executable->ReadAt(
-		// &(kernel->machine->mainMemory[physicalAddr]),
-		// 	noffH.readonlyData.size, noffH.readonlyData.inFileAddr);
-// *************** MP2 *************** //
+	LoadSegment(&noffH.readonlyData, vpn, frame);
+#endif
+    }
+    kernel->machine->InvalidateCode(frame);
+    kernel->frameTable->Unpin(frame);
+
+    pte = &page->translation;
+    pte->physicalPage = frame;
+    pte->use = FALSE;
+    pte->dirty = FALSE;
+    pte->readOnly = ReadOnlyPage(vpn);
+    pte->valid = TRUE;			// nothing can have cached the
+					// invalid entry, so no need to flush
+    DEBUG(dbgAddr, "Page fault: virtual page " << vpn << " into frame "
+		<< frame);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::WriteFault
+// 	The program tried to write virtual address "virtAddr", on a
+//	read-only page.  If the page is mapped to the zero frame, this is
+//	the first write to it: give it a frame of its own, cleared.  If
+//	it shares its frame copy-on-write with other address spaces, give
+//	it a copy of its own.  Either way, it can write the page now.
+//
+//	If the others have copied the page already, or exited, the frame
+//	is ours alone, and we just let ourselves write it.
+//
+//	Returns FALSE if the page really is read-only.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::WriteFault(int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    FrameTable *frameTable = kernel->frameTable;
+    TranslationEntry *pte = pageTable->Translation(vpn);
+    bool zero;
+    int old, frame;
+
+    if (pte == NULL || !pte->valid || ReadOnlyPage(vpn)) {
+	return FALSE;
+    }
+    old = pte->physicalPage;
+    zero = (old == kernel->zeroFrame);
+    if (!zero && frameTable->Info(old)->shared) {
+	return FALSE;			// program text
+    }
+    if (!zero && frameTable->Info(old)->sharers == NULL) {
+	ASSERT(frameTable->Info(old)->owner == this);
+	Unmap(vpn);			// out of the TLB, too
+	pte->physicalPage = old;
+	pte->readOnly = FALSE;
+	pte->valid = TRUE;
+	DEBUG(dbgAddr, "Write fault: virtual page " << vpn
+		<< " no longer shared");
+	return TRUE;
+    }
+
+    if (!zero) {
+	frameTable->Pin(old);		// keep it while we copy it
+    }
+    Unmap(vpn);
+    frame = TakeFrame(vpn);
+    if (zero) {
+	bzero(&kernel->machine->mainMemory[frame * PageSize], PageSize);
+    } else {
+	bcopy(&kernel->machine->mainMemory[old * PageSize],
+		&kernel->machine->mainMemory[frame * PageSize], PageSize);
+	frameTable->Unpin(old);
+	frameTable->Unshare(old, this);
+    }
+    kernel->machine->InvalidateCode(frame);
+    frameTable->Unpin(frame);
+
+    pte->physicalPage = frame;
+    pte->use = FALSE;
+    pte->dirty = !zero;			// a copy isn't in our swap page yet
+    pte->readOnly = FALSE;
+    pte->valid = TRUE;
+    DEBUG(dbgAddr, "Write fault: virtual page " << vpn << " into frame "
+		<< frame << (zero ? ", zeroed" : ", copied"));
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TakeFrame
+// 	Find a frame for virtual page "vpn", and return it pinned.  If
+//	there is no free frame, the frame table's replacement policy picks
+//	a page to push out of memory -- maybe one of ours, or a text page
+//	that the page cache has to take away from everybody mapping it.
+//	A page shared copy-on-write is taken from all its sharers at once,
+//	and each one's page table says where it will be, before any of the
+//	writes starts.  Then none of them can change the page meanwhile,
+//	or fault on it and find the wrong contents; and we don't touch
+//	their address spaces again, as they may exit while we write (the
+//	swap space keeps the swap pages until the writes are done).
+//
+//	If every frame is pinned, the page faults that pinned them are
+//	waiting for the disk; let them finish first.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::TakeFrame(int vpn)
+{
+    FrameTable *frameTable = kernel->frameTable;
+    FrameInfo *info;
+    AddrSpace *owner;
+    List<AddrSpace *> *sharers;
+    int frame, page;
+    bool shared;
+
+    for (;;) {
+	frame = frameTable->Allocate(this, vpn);
+	if (frame != -1) {
+	    frameTable->Pin(frame);
+	    return frame;
+	}
+	frame = frameTable->Victim();
+	if (frame != -1) {
+	    break;
+	}
+	kernel->currentThread->Yield();
+    }
+    info = frameTable->Info(frame);
+    owner = info->owner;
+    page = info->virtualPage;
+    shared = info->shared;
+    sharers = info->sharers;
+    frameTable->Reuse(frame, this, vpn);
+    frameTable->Pin(frame);
+    if (shared) {
+	kernel->pageCache->Evict(frame);
+    } else if (sharers != NULL) {
+	int *swapPages = new int[sharers->NumInList()];
+	int numWrites = 0;
+
+	while (!sharers->IsEmpty()) {
+	    AddrSpace *sharer = sharers->RemoveFront();
+	    int swapTo;
+
+	    sharer->Unmap(page);
+	    swapTo = sharer->SwapOut(page);
+	    if (swapTo != -1) {
+		swapPages[numWrites++] = swapTo;
+	    }
+	}
+	delete sharers;
+	for (int i = 0; i < numWrites; i++) {
+	    kernel->swapSpace->WritePage(swapPages[i], frame);
+	}
+	delete [] swapPages;
+    } else {
+	owner->PageOut(page);
+    }
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageOut
+// 	Push virtual page "vpn" out of memory; the frame it was in has
+//	already been given to someone else.  If the page is dirty, write
+//	it to our swap space, and read it back from there the next time
+//	it is needed.  A clean page can just be dropped, since its swap
+//	page (or the program's file) still has the same contents.
+//
+//	The page is invalid before we start writing, so nothing can change
+//	it in the meantime.  If we fault on it while it is being written,
+//	our read of the swap page waits behind the write at the disk.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::PageOut(int vpn)
+{
+    TranslationEntry *pte = pageTable->Translation(vpn);
+    int frame = pte->physicalPage;
+
+    Unmap(vpn);
+    WriteOut(vpn, frame);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::WriteOut
+// 	Virtual page "vpn" has been unmapped from "frame", which is about
+//	to be reused.  If the page is dirty, write it to our swap space --
+//	or, if it is a page of a mapped file, back to the file.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::WriteOut(int vpn, int frame)
+{
+    PageEntry *page = pageTable->Find(vpn);
+    TranslationEntry *pte = &page->translation;
+    MappedFile *mapping;
+
+    DEBUG(dbgAddr, "Page out: virtual page " << vpn << " from frame "
+		<< frame << (pte->dirty ? ", dirty" : ""));
+    mapping = MappingOf(vpn);
+    if (mapping != NULL) {
+	int offset = (vpn - mapping->firstPage) * PageSize;
+
+	if (!pte->dirty) {
+	    return;
+	}
+	pte->dirty = FALSE;
+	mapping->file->WriteAt(&kernel->machine->mainMemory[frame * PageSize],
+		min(PageSize, mapping->length - offset), offset);
+    } else {
+	int swapTo = SwapOut(vpn);
+
+	if (swapTo != -1) {
+	    kernel->swapSpace->WritePage(swapTo, frame);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SwapOut
+// 	Virtual page "vpn", which isn't a page of a mapped file, has been
+//	unmapped from its frame.  If it is dirty, mark its swap page as
+//	being written, and return it, for the caller to write; otherwise
+//	return -1.
+//
+//	Nothing here blocks, so the page is known to be in swap before
+//	we can fault on it again, and then our read of it waits for the
+//	write (see SwapSpace::ReadPage).
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SwapOut(int vpn)
+{
+    PageEntry *page = pageTable->Find(vpn);
+
+    if (!page->translation.dirty) {
+	return -1;
+    }
+    page->translation.dirty = FALSE;
+    page->inSwap = TRUE;
+    kernel->swapSpace->BeginWrite(page->swapPage);
+    return page->swapPage;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Unmap
+// 	Take virtual page "vpn" out of our page table, and the TLB,
+//	keeping its use and dirty bits; the next use of it faults.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::Unmap(int vpn)
+{
+    TranslationEntry *pte = pageTable->Translation(vpn);
+    TranslationEntry *entry = TLBEntry(vpn);
+
+    ASSERT(pte->valid);
+    if (entry != NULL) {		// the TLB has the latest use and
+	SaveTLBEntry(entry);		// dirty bits
+	entry->valid = FALSE;
     }
+    pte->valid = FALSE;
+    pte->physicalPage = -1;
+    kernel->machine->FlushTranslations();
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TestAndClearUse
+// 	Return whether virtual page "vpn" has been used since the last
+//	time we were asked, and clear its use bit, in the TLB as well as
+//	the page table.
+//
+//	ReadMem and WriteMem don't set the use bit again for a translation
+//	they have cached, so those have to go.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::TestAndClearUse(int vpn)
+{
+    TranslationEntry *pte = pageTable->Translation(vpn);
+    TranslationEntry *entry = TLBEntry(vpn);
+    bool used = pte->use;
+
+    pte->use = FALSE;
+    if (entry != NULL) {
+	used = used || entry->use;
+	entry->use = FALSE;
+    }
+    if (used) {
+	kernel->machine->FlushTranslations();
+    }
+    return used;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ReadOnlyPage
+// 	Return whether virtual page "vpn" holds nothing but read-only
+//	data, so the program must never write it.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::ReadOnlyPage(int vpn)
+{
+#ifdef RDATA
+    return noffH.readonlyData.size > 0
+	&& vpn * PageSize >= noffH.readonlyData.virtualAddr
+	&& (vpn + 1) * PageSize <= noffH.readonlyData.virtualAddr
+				+ noffH.readonlyData.size;
+#else
+    return FALSE;
 #endif
+}
 
-    delete executable;			// close file
-    return TRUE;			// success
+//----------------------------------------------------------------------
+// AddrSpace::LoadSegment
+// 	Read the part of segment "seg" that is on virtual page "vpn" from
+//	the program's file into "frame".
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadSegment(Segment *seg, int vpn, int frame)
+{
+    int pageStart = vpn * PageSize;
+    int from = max(seg->virtualAddr, pageStart);
+    int to = min(seg->virtualAddr + seg->size, pageStart + PageSize);
+
+    if (from < to) {
+	executable->ReadAt(
+		&kernel->machine->mainMemory[frame * PageSize + from - pageStart],
+		to - from, seg->inFileAddr + from - seg->virtualAddr);
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Fork
+// 	Make a copy of this address space, for a child process, without
+//	copying any pages.  The child maps each page we have in a frame
+//	of our own to the same frame, and both of us map it read-only;
+//	whichever writes it first gets a copy (see WriteFault).
+//
+//	Text pages and zero pages are left for the child to fault on, as
+//	if it had been loaded: it will find them in the page cache, or the
+//	zero frame.  So are pages that never left the program's file.
+//	A page we have pushed out to swap is brought back in to be shared,
+//	as the child has a swap page of its own.
+//
+//	Mapped files aren't inherited: the child gets only the program
+//	and the stack.
+//
+//	Returns NULL if there isn't enough swap space for the copy.
+//----------------------------------------------------------------------
+
+AddrSpace *
+AddrSpace::Fork()
+{
+    AddrSpace *child;
+    TranslationEntry *pte, *entry;
+
+    if (kernel->swapSpace->NumFree() < (int) numPages) {
+	return NULL;
+    }
+    child = new AddrSpace();
+    child->executable = kernel->fileSystem->Open(execName);
+    if (child->executable == NULL) {
+	delete child;
+	return NULL;
+    }
+    child->execName = new char[strlen(execName) + 1];
+    strcpy(child->execName, execName);
+    child->noffH = noffH;
+    child->execID = execID;
+    child->numTextPages = numTextPages;
+    child->firstZeroPage = firstZeroPage;
+    child->mapStart = child->nextMapPage = mapStart;
+    child->stackStart = stackStart;
+    child->numPages = numPages;
+
+    for (PageTableIterator iter(pageTable); !iter.IsDone(); iter.Next()) {
+	PageEntry *page = iter.Item();
+	unsigned int vpn = page->translation.virtualPage;
+
+	if (page->swapPage == -1) {	// a mapped file's
+	    continue;
+	}
+	child->pageTable->Add(vpn)->swapPage = kernel->swapSpace->Allocate();
+	if (vpn < numTextPages) {
+	    continue;
+	}
+	pte = &page->translation;
+	if (!pte->valid && page->inSwap) {
+	    PageFault(vpn * PageSize);
+	}
+	if (!pte->valid || pte->physicalPage == kernel->zeroFrame) {
+	    continue;
+	}
+	entry = TLBEntry(vpn);
+	if (entry != NULL) {		// it may say we can write the page
+	    SaveTLBEntry(entry);
+	    entry->valid = FALSE;
+	}
+	pte->readOnly = TRUE;
+	kernel->frameTable->Share(pte->physicalPage, child);
+	entry = child->pageTable->Translation(vpn);
+	*entry = *pte;
+	entry->use = FALSE;
+	entry->dirty = TRUE;		// nothing in its swap page
+    }
+    kernel->machine->FlushTranslations();	// and no cached writes
+    DEBUG(dbgAddr, "Address space forked: " << numPages << " pages");
+    return child;
 }
 
 //----------------------------------------------------------------------
-// AddrSpace::LoadData
-// 	Load a segment with multiple pages to memory.
-//  return true if no exception happen, else raise exception and return false
+// AddrSpace::Mmap
+// 	Map the first "length" bytes of "file" into the address space,
+//	between the program and the stack, and return the address they
+//	start at; -1 if "length" is no good, or there isn't room.  Nothing
+//	is read yet: each page is read from the file the first time the
+//	program touches it (see PageFault).
+//
+//	Mapped pages have no swap pages; the file is where they go when
+//	they leave memory.  Pages of a file that has been unmapped are not
+//	used again.
 //----------------------------------------------------------------------
 
-// *************** MP2 *************** //
-bool 
-AddrSpace::LoadData(int segVirtualAddr, int segInFileAddr, int segSize, OpenFile *executable, int isReadWrite)
+int
+AddrSpace::Mmap(OpenFile *file, int length)
 {
-    // First Page, the size is 0 ~ PageSize-1
-    int remainSize = segSize;
-    int blockSize = PageSize - ((segVirtualAddr + PageSize - 1) % PageSize + 1);
-    int inFileAddr = segInFileAddr;
-    unsigned int virtualAddr = segVirtualAddr;
-    unsigned int physicalAddr;
-    ExceptionType exception = Translate(virtualAddr, &physicalAddr, 1);
-    if(exception != NoException) {
-        kernel->machine->RaiseException(exception, 0);
-        return FALSE;
+    MappedFile *mapping;
+    unsigned int pages;
+
+    if (length <= 0) {
+	return -1;
     }
-    executable->ReadAt(&(kernel->machine->mainMemory[physicalAddr]), blockSize, inFileAddr);
-    virtualAddr += blockSize;
-    inFileAddr += blockSize;
-    remainSize -= blockSize;
-
-    // Second to second last page, the size is PageSize
-    while(remainSize >= PageSize) {
-        if(!isReadWrite) pageTable[virtualAddr / PageSize].readOnly = TRUE;
-        exception = Translate(virtualAddr, &physicalAddr, isReadWrite);
-        if(exception != NoException) {
-            kernel->machine->RaiseException(exception, 0);
-            return FALSE;
-        }
-        executable->ReadAt(&(kernel->machine->mainMemory[physicalAddr]), PageSize, inFileAddr);
-        virtualAddr += PageSize;
-        inFileAddr += PageSize;
-        remainSize -= PageSize;
-    }
-    
-    // Last Page, the size is 0 ~ PageSize-1
-    exception = Translate(virtualAddr, &physicalAddr, 1);
-    if(exception != NoException) {
-        kernel->machine->RaiseException(exception, 0);
-        return FALSE;
+    pages = divRoundUp(length, PageSize);
+    if (pages > stackStart - nextMapPage) {
+	return -1;
+    }
+    for (unsigned int vpn = nextMapPage; vpn < nextMapPage + pages; vpn++) {
+	pageTable->Add(vpn);
+    }
+
+    mapping = new MappedFile;
+    mapping->firstPage = nextMapPage;
+    mapping->numPages = pages;
+    mapping->length = length;
+    mapping->file = file;
+    mappings->Append(mapping);
+    nextMapPage += pages;
+    DEBUG(dbgAddr, "Mapped " << length << " bytes at virtual page "
+		<< mapping->firstPage);
+    return mapping->firstPage * PageSize;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Munmap
+// 	Remove the mapped file that starts at "virtAddr", writing its dirty
+//	pages back to the file first.  Returns FALSE if no file is mapped
+//	there.
+//
+//	Each page's frame is pinned while it is written back, so nobody
+//	can take it in the meantime.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::Munmap(int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    MappedFile *mapping = MappingOf(vpn);
+    int frame;
+
+    if (mapping == NULL || mapping->firstPage != vpn
+		|| (unsigned) virtAddr % PageSize != 0) {
+	return FALSE;
     }
-    executable->ReadAt(&(kernel->machine->mainMemory[physicalAddr]), PageSize, inFileAddr);
-    virtualAddr += remainSize;
-    inFileAddr += remainSize;
+    for (unsigned int i = vpn; i < vpn + mapping->numPages; i++) {
+	TranslationEntry *pte = pageTable->Translation(i);
 
-    ASSERT(virtualAddr == segVirtualAddr + segSize);
-    ASSERT(inFileAddr == segInFileAddr + segSize);
+	if (pte->valid) {
+	    frame = pte->physicalPage;
+	    kernel->frameTable->Pin(frame);
+	    Unmap(i);
+	    WriteOut(i, frame);
+	    kernel->frameTable->Unpin(frame);
+	    kernel->frameTable->Free(frame);
+	}
+	pageTable->Remove(i);
+    }
+    mappings->Remove(mapping);
+    delete mapping->file;
+    delete mapping;
+    DEBUG(dbgAddr, "Unmapped virtual page " << vpn);
     return TRUE;
 }
-// *************** MP2 *************** //
+
+//----------------------------------------------------------------------
+// AddrSpace::MappingOf
+// 	Return the mapped file that virtual page "vpn" is in, or NULL if
+//	it isn't in one.
+//----------------------------------------------------------------------
+
+MappedFile *
+AddrSpace::MappingOf(unsigned int vpn)
+{
+    ListIterator<MappedFile *> iter(mappings);
+
+    if (vpn < mapStart || vpn >= nextMapPage) {
+	return NULL;
+    }
+    for (; !iter.IsDone(); iter.Next()) {
+	MappedFile *mapping = iter.Item();
+
+	if (vpn >= mapping->firstPage
+		&& vpn < mapping->firstPage + mapping->numPages) {
+	    return mapping;
+	}
+    }
+    return NULL;
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::Execute
@@ -353,8 +912,8 @@ AddrSpace::InitRegisters()
    // Set the stack register to the end of the address space, where we
    // allocated the stack; but subtract off a bit, to make sure we don't
    // accidentally reference off the end!
-    machine->WriteRegister(StackReg, numPages * PageSize - 16);
-    DEBUG(dbgAddr, "Initializing stack pointer: " << numPages * PageSize - 16);
+    machine->WriteRegister(StackReg, UserStackTop - 16);
+    DEBUG(dbgAddr, "Initializing stack pointer: " << UserStackTop - 16);
 }
 
 //----------------------------------------------------------------------
@@ -373,13 +932,134 @@ void AddrSpace::SaveState()
 // 	On a context switch, restore the machine state so that
 //	this address space can run.
 //
-//      For now, tell the machine where to find the page table.
+//      Tell the machine where to find the page table -- or, if it
+//	translates through a TLB, which TLB entries are ours.
 //----------------------------------------------------------------------
 
 void AddrSpace::RestoreState() 
 {
-    kernel->machine->pageTable = pageTable;
-    kernel->machine->pageTableSize = numPages;
+    Machine *machine = kernel->machine;
+
+    if (machine->tlb == NULL) {
+	machine->pageTable = pageTable;
+    } else {
+	if (asidOwner[asid] != this) {
+	    NewASID();
+	}
+	machine->SetASID(asid);
+    }
+    machine->FlushTranslations();
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::RefillTLB
+// 	Handle a TLB miss at "virtAddr", by loading the translation from
+//	our page table into the TLB.  If that pushes out another entry,
+//	save its use and dirty bits.
+//
+//	Returns FALSE if the page isn't in our page table, so this is a
+//	real page fault.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::RefillTLB(int virtAddr)
+{
+    unsigned int vpn = (unsigned) virtAddr / PageSize;
+    TranslationEntry *pte = pageTable->Translation(vpn);
+    TranslationEntry evicted;
+
+    if (pte == NULL || !pte->valid) {
+	return FALSE;
+    }
+    if (kernel->machine->WriteTLB(pte, &evicted)) {
+	SaveTLBEntry(&evicted);
+    }
+    kernel->stats->numTLBRefills++;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::NewASID
+// 	Give us an address space ID, to tag our translations in the TLB
+//	with.  There are only NumASIDs of them, so once they have all been
+//	handed out, flush the TLB and take them back from everybody; each
+//	address space gets a new one the next time it runs.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::NewASID()
+{
+    Machine *machine = kernel->machine;
+
+    if (lastASID == NumASIDs - 1) {
+	for (int i = 0; i < machine->tlbSize; i++) {
+	    if (machine->tlb[i].valid) {
+		SaveTLBEntry(&machine->tlb[i]);
+		machine->tlb[i].valid = FALSE;
+	    }
+	}
+	machine->FlushTranslations();
+	for (int i = 0; i < NumASIDs; i++) {
+	    asidOwner[i] = NULL;
+	}
+	lastASID = -1;
+    }
+    asid = ++lastASID;
+    asidOwner[asid] = this;
+    DEBUG(dbgAddr, "Address space gets ASID " << asid);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TLBEntry
+// 	Return our TLB entry for virtual page "vpn", or NULL if it isn't
+//	in the TLB.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+AddrSpace::TLBEntry(int vpn)
+{
+    Machine *machine = kernel->machine;
+
+    if (machine->tlb == NULL || asidOwner[asid] != this) {
+	return NULL;
+    }
+    for (int i = 0; i < machine->tlbSize; i++) {
+	TranslationEntry *entry = &machine->tlb[i];
+
+	if (entry->valid && entry->asid == asid
+		&& entry->virtualPage == vpn) {
+	    return entry;
+	}
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SaveTLBEntry
+// 	A translation is leaving the TLB.  The hardware has been setting
+//	the use and dirty bits in the TLB entry; copy them to the page
+//	table of the address space it belongs to, if that still exists.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::SaveTLBEntry(TranslationEntry *entry)
+{
+    AddrSpace *owner = asidOwner[entry->asid];
+
+    if (owner != NULL) {
+	TranslationEntry *pte =
+		owner->pageTable->Translation(entry->virtualPage);
+
+	if (pte == NULL) {		// unmapped since
+	    return;
+	}
+	if (entry->use) {
+	    pte->use = TRUE;
+	}
+	if (entry->dirty) {
+	    pte->dirty = TRUE;
+	}
+    }
 }
 
 
@@ -399,11 +1079,15 @@ AddrSpace::Translate(unsigned int vaddr, unsigned int *paddr, int isReadWrite)
     unsigned int      vpn    = vaddr / PageSize;
     unsigned int      offset = vaddr % PageSize;
 
-    if(vpn >= numPages) {
+    pte = pageTable->Translation(vpn);
+
+    if(pte == NULL) {
         return AddressErrorException;
     }
 
-    pte = &pageTable[vpn];
+    if(!pte->valid) {
+        return PageFaultException;
+    }
 
     if(isReadWrite && pte->readOnly) {
         return ReadOnlyException;
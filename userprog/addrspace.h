@@ -15,8 +15,25 @@
 
 #include "copyright.h"
 #include "filesys.h"
+#include "noff.h"
+#include "list.h"
+#include "pagetable.h"
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define UserStackTop	0x80000000U	// the stack grows down from the top
+					// of user space, far from the program
+
+// A file mapped into an address space by Mmap.  Its pages are read
+// from the file when the program touches them, and written back to it
+// when they are dirty and leave memory, or are unmapped.
+
+class MappedFile {
+  public:
+    unsigned int firstPage;		// virtual page it starts at
+    unsigned int numPages;
+    int length;				// bytes of the file mapped
+    OpenFile *file;			// the mapping's own OpenFile
+};
 
 class AddrSpace {
   public:
@@ -27,6 +44,18 @@ class AddrSpace {
                                         // a file
 					// return false if not found
 
+    AddrSpace *Fork();			// Copy the address space, sharing
+					// its pages copy-on-write; NULL if
+					// there is no room
+
+    int Mmap(OpenFile *file, int length);
+					// Map the first "length" bytes of
+					// "file"; returns the address, or
+					// -1.  The mapping owns "file"
+    bool Munmap(int virtAddr);		// Write back and remove the mapping
+					// at "virtAddr"; FALSE if there is
+					// none
+
     void Execute(char *fileName);             	// Run a program
 					// assumes the program has already
                                         // been loaded
@@ -39,17 +68,70 @@ class AddrSpace {
     // is 0 for Read, 1 for Write.
     ExceptionType Translate(unsigned int vaddr, unsigned int *paddr, int mode);
 
+    bool PageFault(int virtAddr);	// Bring the page at "virtAddr" into
+					// memory; FALSE if it isn't ours
+    bool WriteFault(int virtAddr);	// Give the page at "virtAddr" a
+					// frame of its own, if it is the
+					// zero page or shared copy-on-write;
+					// FALSE if it is really read-only
+    void PageOut(int vpn);		// Push virtual page "vpn" out of
+					// memory, to make room for another
+    void Unmap(int vpn);		// Drop the mapping of page "vpn"
+    bool TestAndClearUse(int vpn);	// Has page "vpn" been used since
+					// the last time we asked?
+    bool RefillTLB(int virtAddr);	// Load the translation of
+					// "virtAddr" into the TLB; FALSE
+					// if it isn't in our page table
+
   private:
-    TranslationEntry *pageTable;	// Assume linear page table translation
-					// for now!
-    unsigned int numPages;		// Number of pages in the virtual 
-					// address space
+    PageTable *pageTable;		// only has the pages that are in
+					// the address space
+    unsigned int numPages;		// Number of pages in the program
+					// and its stack, each with a swap page
 
     void InitRegisters();		// Initialize user-level CPU registers,
 					// before jumping to user code
-// *************** MP2 *************** //
-    bool LoadData(int segVirtualAddr, int segInFileAddr, int segSize, OpenFile *executable, int isReadWrite);
-// *************** MP2 *************** //
+
+    int asid;				// tags our translations in the TLB,
+					// if asidOwner[asid] is us
+    void NewASID();			// hand us a free ASID
+
+    static int lastASID;		// the ASID handed out last
+    static AddrSpace *asidOwner[NumASIDs];
+					// address space each ASID belongs to
+    static void SaveTLBEntry(TranslationEntry *entry);
+					// copy the use and dirty bits of a
+					// TLB entry to its page table
+    TranslationEntry *TLBEntry(int vpn);
+					// our TLB entry for page "vpn", if
+					// there is one
+    OpenFile *executable;		// the program, to load pages from
+    char *execName;			// its name, for a Fork to open it
+    NoffHeader noffH;			// where its segments are
+    int execID;				// the program, to the page cache
+    unsigned int numTextPages;		// pages below this hold nothing but
+					// code and read-only data, and are
+					// shared through the page cache
+    unsigned int firstZeroPage;		// pages from this one on hold
+					// nothing from the file (BSS and
+					// stack), and start out zero
+    unsigned int mapStart;		// files are mapped from the end of
+    unsigned int nextMapPage;		// the program up to here
+    unsigned int stackStart;		// first page of the stack
+    List<MappedFile *> *mappings;	// the files mapped by Mmap
+    MappedFile *MappingOf(unsigned int vpn);
+					// the mapped file page "vpn" is in,
+					// or NULL
+    int TakeFrame(int vpn);		// find a frame for page "vpn"
+    void WriteOut(int vpn, int frame);	// save page "vpn", which was in
+					// "frame", if it is dirty
+    int SwapOut(int vpn);		// start saving it to swap: returns
+					// the swap page to write, or -1
+    bool ReadOnlyPage(int vpn);		// does page "vpn" hold nothing but
+					// read-only data?
+    void LoadSegment(Segment *seg, int vpn, int frame);
+					// read the part of a segment that
+					// is on a page into its frame
 
 };
 
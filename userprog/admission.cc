@@ -0,0 +1,150 @@
+// admission.cc
+//	Routines to make user programs wait for room in the swap space,
+//	and to let them in when there is some.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "admission.h"
+#include "swapspace.h"
+
+//----------------------------------------------------------------------
+// InOrder, SmallestFirst
+// 	Compare two waiting programs, for the two ways of ordering the
+//	queue.  Programs the same size go in the order they came.
+//----------------------------------------------------------------------
+
+static int
+InOrder(AdmissionRequest *x, AdmissionRequest *y)
+{
+    return x->arrival - y->arrival;
+}
+
+static int
+SmallestFirst(AdmissionRequest *x, AdmissionRequest *y)
+{
+    if (x->pages != y->pages) {
+	return x->pages - y->pages;
+    }
+    return InOrder(x, y);
+}
+
+//----------------------------------------------------------------------
+// AdmissionQueue::AdmissionQueue
+// 	Initialize an empty admission queue, ordered by "t".
+//----------------------------------------------------------------------
+
+AdmissionQueue::AdmissionQueue(AdmissionType t)
+{
+    type = t;
+    waiting = new SortedList<AdmissionRequest *>(
+		(type == SmallestFirstAdmission) ? SmallestFirst : InOrder);
+    promised = 0;
+    numArrivals = 0;
+}
+
+//----------------------------------------------------------------------
+// AdmissionQueue::~AdmissionQueue
+//----------------------------------------------------------------------
+
+AdmissionQueue::~AdmissionQueue()
+{
+    delete waiting;
+}
+
+//----------------------------------------------------------------------
+// AdmissionQueue::ParseType
+// 	Convert the name of an order, as given to "-adm", into its type.
+//	Returns FALSE if there is no such order.
+//----------------------------------------------------------------------
+
+bool
+AdmissionQueue::ParseType(char *name, AdmissionType *type)
+{
+    if (strcmp(name, "fifo") == 0) {
+	*type = FIFOAdmission;
+    } else if (strcmp(name, "small") == 0) {
+	*type = SmallestFirstAdmission;
+    } else {
+	return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AdmissionQueue::Fits
+// 	Return whether "pages" swap pages are free, not counting the ones
+//	promised to programs that have been let in but haven't run yet.
+//----------------------------------------------------------------------
+
+bool
+AdmissionQueue::Fits(int pages)
+{
+    return kernel->swapSpace->NumFree() - promised >= pages;
+}
+
+//----------------------------------------------------------------------
+// AdmissionQueue::Admit
+// 	Wait until the current thread's program can be given "pages" swap
+//	pages.  If the queue is in arrival order, a program only gets in
+//	straight away if nobody is waiting ahead of it.
+//
+//	Returns FALSE, without waiting, if the program wouldn't fit even
+//	in an empty swap space.
+//
+//	Interrupts must be off, and are still off on return, so the caller
+//	can take the pages before anybody else gets to run.  Something
+//	else may still have taken them while we were waking up (a Fork
+//	doesn't queue), in which case we go back in line, in our old place.
+//----------------------------------------------------------------------
+
+bool
+AdmissionQueue::Admit(int pages)
+{
+    AdmissionRequest request;
+
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    if (pages > NumSwapPages) {
+	return FALSE;
+    }
+    if (Fits(pages) && (type == SmallestFirstAdmission || waiting->IsEmpty())) {
+	return TRUE;
+    }
+
+    request.thread = kernel->currentThread;
+    request.pages = pages;
+    request.arrival = numArrivals++;
+    do {
+	DEBUG(dbgAddr, "Waiting for " << pages << " swap pages, behind "
+		<< waiting->NumInList() << " programs");
+	waiting->Insert(&request);
+	kernel->currentThread->Sleep(FALSE);
+	promised -= pages;		// Release set them aside for us
+    } while (!Fits(pages));
+    DEBUG(dbgAddr, "Admitted, with " << pages << " swap pages");
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AdmissionQueue::Release
+// 	Swap pages have been given back.  Wake up the programs at the
+//	front of the queue, as long as there is room for them, setting
+//	their pages aside until they run.
+//----------------------------------------------------------------------
+
+void
+AdmissionQueue::Release()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    while (!waiting->IsEmpty() && Fits(waiting->Front()->pages)) {
+	AdmissionRequest *request = waiting->RemoveFront();
+
+	promised += request->pages;
+	kernel->scheduler->ReadyToRun(request->thread);
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
@@ -0,0 +1,71 @@
+// admission.h
+//	Data structures for admitting user programs to the system.
+//
+//	A program is given a swap page for each of its virtual pages when
+//	it is loaded (see AddrSpace::Load), so the swap space bounds how
+//	many programs can be in the system at once.  A program that comes
+//	along when there isn't room waits in the admission queue, instead
+//	of failing, and is let in once programs that have finished give
+//	back enough swap pages.  Only a program bigger than the whole swap
+//	space is turned away.
+//
+//	Waiting programs are let in either in the order they came, or
+//	smallest first, which gets more of them through sooner but can
+//	keep a big one waiting for a long time.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ADMISSION_H
+#define ADMISSION_H
+
+#include "copyright.h"
+#include "list.h"
+
+class Thread;
+
+// The orders the kernel can be booted with (see "-adm").
+enum AdmissionType { FIFOAdmission, SmallestFirstAdmission };
+
+// A program waiting to be let in.
+
+class AdmissionRequest {
+  public:
+    Thread *thread;			// the thread loading it
+    int pages;				// swap pages it needs
+    int arrival;			// when it first had to wait
+};
+
+// The following class defines the admission queue.
+
+class AdmissionQueue {
+  public:
+    AdmissionQueue(AdmissionType t);	// nobody waiting
+    ~AdmissionQueue();
+
+    static bool ParseType(char *name, AdmissionType *type);
+					// "fifo" or "small"
+
+    bool Admit(int pages);		// wait until "pages" swap pages
+					// are free; FALSE if they never
+					// can be.  Interrupts must be off.
+    void Release();			// swap pages have been given back:
+					// let in whoever now fits
+
+    int NumWaiting() { return waiting->NumInList(); }
+
+  private:
+    AdmissionType type;
+    SortedList<AdmissionRequest *> *waiting;
+					// in the order they are let in
+    int promised;			// free swap pages set aside for
+					// programs let in, but not yet
+					// running to take them
+    int numArrivals;			// programs that have had to wait
+
+    bool Fits(int pages);		// are there "pages" free swap pages
+					// nobody has been promised?
+};
+
+#endif // ADMISSION_H
@@ -25,6 +25,126 @@
 #include "main.h"
 #include "syscall.h"
 #include "ksyscall.h"
+
+const int MaxUserString = 256;	// longest string a syscall takes,
+				// including the terminating '\0'
+
+//----------------------------------------------------------------------
+// UserBytes
+// 	Find the byte of the current user program's memory at virtual
+//	address "virtAddr", bringing its page into memory if need be.
+//	The bytes after it, up to the end of the page, follow it in main
+//	memory; "*run" is set to how many bytes that is, counting it.
+//	Returns NULL if the address is bad (or, when "writing", the page
+//	is read-only).
+//----------------------------------------------------------------------
+
+static char *
+UserBytes(int virtAddr, bool writing, int *run)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    unsigned int physAddr;
+    ExceptionType exception;
+
+    exception = space->Translate(virtAddr, &physAddr, writing);
+    if (exception == PageFaultException && space->PageFault(virtAddr)) {
+	exception = space->Translate(virtAddr, &physAddr, writing);
+    }
+    if (exception == ReadOnlyException && space->WriteFault(virtAddr)) {
+	exception = space->Translate(virtAddr, &physAddr, writing);
+    }
+    if (exception != NoException) {
+	return NULL;
+    }
+    *run = PageSize - physAddr % PageSize;
+    return &kernel->machine->mainMemory[physAddr];
+}
+
+//----------------------------------------------------------------------
+// CopyIn, CopyOut
+// 	Copy "size" bytes between the current user program's memory, at
+//	virtual address "virtAddr", and the kernel's "buffer".  The user
+//	buffer is translated a page at a time, and each page's part of it
+//	copied in one go, so it doesn't matter where the pages are in
+//	main memory.  Return FALSE if part of the user buffer is bad.
+//
+//	Bringing one page in may push out a page we have already copied,
+//	but never the one we are copying.
+//----------------------------------------------------------------------
+
+static bool
+CopyIn(int virtAddr, char *buffer, int size)
+{
+    while (size > 0) {
+	int run;
+	char *bytes = UserBytes(virtAddr, FALSE, &run);
+
+	if (bytes == NULL) {
+	    return FALSE;
+	}
+	run = min(run, size);
+	memcpy(buffer, bytes, run);
+	virtAddr += run;
+	buffer += run;
+	size -= run;
+    }
+    return TRUE;
+}
+
+static bool
+CopyOut(int virtAddr, char *buffer, int size)
+{
+    while (size > 0) {
+	int run;
+	char *bytes = UserBytes(virtAddr, TRUE, &run);
+
+	if (bytes == NULL) {
+	    return FALSE;
+	}
+	run = min(run, size);
+	memcpy(bytes, buffer, run);
+	kernel->machine->InvalidateCode(
+		(bytes - kernel->machine->mainMemory) / PageSize);
+	virtAddr += run;
+	buffer += run;
+	size -= run;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CopyInString
+// 	Copy the '\0'-terminated string at virtual address "virtAddr" in
+//	the current user program into "buffer", which holds MaxUserString
+//	bytes, a page at a time.  Return FALSE if the string is bad or too
+//	long.
+//----------------------------------------------------------------------
+
+static bool
+CopyInString(int virtAddr, char *buffer)
+{
+    int copied = 0;
+
+    while (copied < MaxUserString) {
+	int run;
+	char *bytes = UserBytes(virtAddr + copied, FALSE, &run);
+	char *end;
+
+	if (bytes == NULL) {
+	    return FALSE;
+	}
+	run = min(run, MaxUserString - copied);
+	end = (char *) memchr(bytes, '\0', run);
+	if (end != NULL) {
+	    memcpy(buffer + copied, bytes, end - bytes + 1);
+	    return TRUE;
+	}
+	memcpy(buffer + copied, bytes, run);
+	copied += run;
+    }
+    return FALSE;
+}
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 // 	Entry point into the Nachos kernel.  Called when a user program
@@ -82,18 +202,33 @@ ExceptionHandler(ExceptionType which)
 		DEBUG(dbgSys, "Message received.\n");
 		val = kernel->machine->ReadRegister(4);
 		{
-		char *msg = &(kernel->machine->mainMemory[val]);
-		cout << msg << endl;
+		char msg[MaxUserString];
+		if (CopyInString(val, msg))
+		    cout << msg << endl;
 		}
 		SysHalt();
 		ASSERTNOTREACHED();
 	    break;
+	    case SC_Fork:
+		DEBUG(dbgSys, "Fork\n");
+		// the child starts after the syscall, too
+		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+		kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
+		kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+		status = SysFork();
+		kernel->machine->WriteRegister(2, (int) status);
+		return;
+		ASSERTNOTREACHED();
+	    break;
 	    case SC_Create:
 		val = kernel->machine->ReadRegister(4);
 		{
-		char *filename = &(kernel->machine->mainMemory[val]);
+		char filename[MaxUserString];
 		//cout << filename << endl;
-		status = SysCreate(filename);
+		if (CopyInString(val, filename))
+		    status = SysCreate(filename);
+		else
+		    status = 0;
 		kernel->machine->WriteRegister(2, (int) status);
 		}
 		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -140,8 +275,11 @@ ExceptionHandler(ExceptionType which)
 	case SC_Open:
 		val = kernel->machine->ReadRegister(4);
 		{
-		char *filename = &(kernel->machine->mainMemory[val]);
-		status = SysOpen(filename);
+		char filename[MaxUserString];
+		if (CopyInString(val, filename))
+		    status = SysOpen(filename);
+		else
+		    status = -1;
 		kernel->machine->WriteRegister(2, (int)status);
 		}
 		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -155,8 +293,12 @@ ExceptionHandler(ExceptionType which)
 		numChar = kernel->machine->ReadRegister(5);
 		fileID = kernel->machine->ReadRegister(6);
 		{
-		char *buffer = &(kernel->machine->mainMemory[val]);
-		status = SysWrite(buffer, numChar, fileID);
+		char *buffer = new char[max(numChar, 0)];
+		if (numChar >= 0 && CopyIn(val, buffer, numChar))
+		    status = SysWrite(buffer, numChar, fileID);
+		else
+		    status = -1;
+		delete [] buffer;
 		kernel->machine->WriteRegister(2, (int)status);
 		}
 		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -170,8 +312,11 @@ ExceptionHandler(ExceptionType which)
 		numChar = kernel->machine->ReadRegister(5);
 		fileID = kernel->machine->ReadRegister(6);
 		{
-		char *buffer = &(kernel->machine->mainMemory[val]);
-		status = SysRead(buffer, numChar, fileID);
+		char *buffer = new char[max(numChar, 0)];
+		status = (numChar >= 0) ? SysRead(buffer, numChar, fileID) : -1;
+		if (status > 0 && !CopyOut(val, buffer, status))
+		    status = -1;
+		delete [] buffer;
 		kernel->machine->WriteRegister(2, (int)status);
 		}
 		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
@@ -180,6 +325,36 @@ ExceptionHandler(ExceptionType which)
 		return;
 		ASSERTNOTREACHED();
 		break;
+	case SC_Mmap:
+		fileID = kernel->machine->ReadRegister(4);
+		numChar = kernel->machine->ReadRegister(5);
+		status = SysMmap(fileID, numChar);
+		kernel->machine->WriteRegister(2, (int)status);
+		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+		kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg)+4);
+		kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+		return;
+		ASSERTNOTREACHED();
+		break;
+	case SC_Munmap:
+		val = kernel->machine->ReadRegister(4);
+		status = SysMunmap(val);
+		kernel->machine->WriteRegister(2, (int)status);
+		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+		kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg)+4);
+		kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+		return;
+		ASSERTNOTREACHED();
+		break;
+	case SC_Sync:
+		DEBUG(dbgSys, "Sync\n");
+		SysSync();
+		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
+		kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg)+4);
+		kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
+		return;
+		ASSERTNOTREACHED();
+		break;
 	case SC_Close:
 		fileID = kernel->machine->ReadRegister(4);
 		{
@@ -198,6 +373,26 @@ ExceptionHandler(ExceptionType which)
 	    break;
 	}
 	break;
+    case PageFaultException:
+	val = kernel->machine->ReadRegister(BadVAddrReg);
+	if (kernel->machine->tlb != NULL
+		&& kernel->currentThread->space->RefillTLB(val)) {
+	    return;		// just a TLB miss: run the instruction again
+	}
+	if (kernel->currentThread->space->PageFault(val)) {
+	    return;		// the page is in memory now: try again
+	}
+	cerr << "Page fault at virtual address " << val << "\n";
+	break;
+    case ReadOnlyException:
+	val = kernel->machine->ReadRegister(BadVAddrReg);
+	if (kernel->currentThread->space->WriteFault(val)) {
+	    return;		// it has a page it can write now (zero
+				// filled, copied, or no longer shared):
+				// try again
+	}
+	cerr << "Write to read-only page at virtual address " << val << "\n";
+	break;
 	default:
 		cerr << "Unexpected user mode exception " << (int)which << "\n";
 		break;
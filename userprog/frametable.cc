@@ -0,0 +1,308 @@
+// frametable.cc
+//	Routines to allocate frames of physical memory to address
+//	spaces, and to keep track of what is in each of them.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "frametable.h"
+#include "addrspace.h"
+#include "pagecache.h"
+
+const int FramesPerWord = 64;		// bits in an unsigned long long
+
+//----------------------------------------------------------------------
+// FrameTable::FrameTable
+// 	Initialize the frame table, with every frame free.
+//
+//	"nFrames" is the number of frames of physical memory
+//	"replacement" chooses which frame to take when none is free; the
+//		frame table deletes it when it is done with it
+//----------------------------------------------------------------------
+
+FrameTable::FrameTable(int nFrames, ReplacementPolicy *replacement)
+{
+    numFrames = nFrames;
+    numFree = nFrames;
+    policy = replacement;
+    frames = new FrameInfo[numFrames];
+    for (int i = 0; i < numFrames; i++) {
+	frames[i].owner = NULL;
+	frames[i].shared = FALSE;
+	frames[i].sharers = NULL;
+	frames[i].virtualPage = -1;
+	frames[i].pinCount = 0;
+    }
+    numWords = divRoundUp(numFrames, FramesPerWord);
+    freeMap = new unsigned long long[numWords];
+    for (int w = 0; w < numWords; w++) {
+	int bits = min(FramesPerWord, numFrames - w * FramesPerWord);
+
+	freeMap[w] = (bits == FramesPerWord) ? ~0ULL : (1ULL << bits) - 1;
+    }
+    firstFreeWord = 0;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::~FrameTable
+//----------------------------------------------------------------------
+
+FrameTable::~FrameTable()
+{
+    delete [] frames;
+    delete [] freeMap;
+    delete policy;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Allocate
+// 	Take the lowest numbered free frame, to hold virtual page
+//	"virtualPage" of "owner".  Returns the frame number, or -1 if
+//	every frame is in use.
+//----------------------------------------------------------------------
+
+int
+FrameTable::Allocate(AddrSpace *owner, int virtualPage)
+{
+    int frame;
+
+    if (numFree == 0) {
+	return -1;
+    }
+    while (freeMap[firstFreeWord] == 0) {
+	firstFreeWord++;
+    }
+    frame = firstFreeWord * FramesPerWord
+		+ __builtin_ctzll(freeMap[firstFreeWord]);
+    freeMap[firstFreeWord] &= freeMap[firstFreeWord] - 1;	// lowest bit
+    numFree--;
+
+    frames[frame].owner = owner;
+    frames[frame].shared = FALSE;
+    frames[frame].sharers = NULL;
+    frames[frame].virtualPage = virtualPage;
+    frames[frame].pinCount = 0;
+    policy->Loaded(frame);
+    DEBUG(dbgAddr, "Frame " << frame << " allocated for virtual page "
+		<< virtualPage);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Free
+// 	Give "frame" back; it mustn't be pinned.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Free(int frame)
+{
+    int w = frame / FramesPerWord;
+    unsigned long long bit = 1ULL << (frame % FramesPerWord);
+
+    ASSERT(frame >= 0 && frame < numFrames);
+    ASSERT(!(freeMap[w] & bit));		// not free already
+    ASSERT(frames[frame].pinCount == 0 && frames[frame].sharers == NULL);
+    freeMap[w] |= bit;
+    if (w < firstFreeWord) {
+	firstFreeWord = w;
+    }
+    numFree++;
+    frames[frame].owner = NULL;
+    frames[frame].shared = FALSE;
+    frames[frame].virtualPage = -1;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::IsFree
+// 	Is "frame" free?
+//----------------------------------------------------------------------
+
+bool
+FrameTable::IsFree(int frame)
+{
+    ASSERT(frame >= 0 && frame < numFrames);
+    return (freeMap[frame / FramesPerWord]
+		& (1ULL << (frame % FramesPerWord))) != 0;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Reuse
+// 	Hand "frame", which Victim chose, over to virtual page
+//	"virtualPage" of "owner".  The caller is responsible for getting
+//	the old page out of it -- out of every address space sharing it,
+//	and for deleting the list of them.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Reuse(int frame, AddrSpace *owner, int virtualPage)
+{
+    ASSERT(!IsFree(frame) && !IsPinned(frame));
+    frames[frame].owner = owner;
+    frames[frame].shared = FALSE;
+    frames[frame].sharers = NULL;
+    frames[frame].virtualPage = virtualPage;
+    policy->Loaded(frame);
+    DEBUG(dbgAddr, "Frame " << frame << " reused for virtual page "
+		<< virtualPage);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Referenced
+// 	Return whether the page in "frame" has been used since the last
+//	time we asked, and clear its use bit.  A shared page may be
+//	mapped by several address spaces; the page cache asks them all,
+//	as we do for a page shared copy-on-write.
+//	Frames in the self test have no owner, and are never used.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::Referenced(int frame)
+{
+    FrameInfo *info = Info(frame);
+
+    if (info->shared) {
+	return kernel->pageCache->Referenced(frame);
+    }
+    if (info->sharers != NULL) {
+	ListIterator<AddrSpace *> iter(info->sharers);
+	bool used = FALSE;
+
+	for (; !iter.IsDone(); iter.Next()) {
+	    if (iter.Item()->TestAndClearUse(info->virtualPage)) {
+		used = TRUE;
+	    }
+	}
+	return used;
+    }
+    if (info->owner == NULL) {
+	return FALSE;
+    }
+    return info->owner->TestAndClearUse(info->virtualPage);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Share
+// 	"space" now maps "frame" too, copy-on-write.  The first time the
+//	frame is shared, its owner becomes the first of its sharers.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Share(int frame, AddrSpace *space)
+{
+    FrameInfo *info = Info(frame);
+
+    ASSERT(!IsFree(frame) && !info->shared);
+    if (info->sharers == NULL) {
+	info->sharers = new List<AddrSpace *>;
+	info->sharers->Append(info->owner);
+	info->owner = NULL;
+    }
+    info->sharers->Append(space);
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Unshare
+// 	"space" no longer maps "frame", having copied the page or exited.
+//	If just one address space is left sharing it, the frame is that
+//	one's own again; if none is, it is free.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Unshare(int frame, AddrSpace *space)
+{
+    FrameInfo *info = Info(frame);
+
+    if (info->sharers == NULL) {	// the others have all gone
+	ASSERT(info->owner == space);
+	Free(frame);
+	return;
+    }
+    ASSERT(info->sharers->IsInList(space));
+    info->sharers->Remove(space);
+    if (info->sharers->NumInList() == 1) {
+	info->owner = info->sharers->RemoveFront();
+	delete info->sharers;
+	info->sharers = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Info
+// 	Return the frame table entry for "frame".
+//----------------------------------------------------------------------
+
+FrameInfo *
+FrameTable::Info(int frame)
+{
+    ASSERT(frame >= 0 && frame < numFrames);
+    return &frames[frame];
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Pin, FrameTable::Unpin
+// 	Keep "frame" with its owner until it is unpinned.  Pins nest.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Pin(int frame)
+{
+    Info(frame)->pinCount++;
+}
+
+void
+FrameTable::Unpin(int frame)
+{
+    ASSERT(Info(frame)->pinCount > 0);
+    Info(frame)->pinCount--;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::SelfTest
+// 	Allocate every frame of a table (whose last word isn't full),
+//	free every third one, and check that they come back lowest first.
+//	Then check that FIFO replacement takes the frame filled first,
+//	but never a pinned one.
+//----------------------------------------------------------------------
+
+void
+FrameTable::SelfTest()
+{
+    const int n = 2 * FramesPerWord + 5;
+    FrameTable *table =
+	new FrameTable(n, ReplacementPolicy::Create(FIFOReplacement, n));
+    int i;
+
+    for (i = 0; i < n; i++) {
+	ASSERT(table->Allocate(NULL, i) == i);
+    }
+    ASSERT(table->Allocate(NULL, n) == -1);
+    for (i = n - 1; i >= 0; i -= 3) {
+	table->Free(i);
+    }
+    ASSERT(table->NumFree() == (n + 2) / 3);
+    for (i = (n - 1) % 3; i < n; i += 3) {
+	ASSERT(table->Allocate(NULL, i) == i);
+	ASSERT(table->Info(i)->virtualPage == i);
+    }
+    ASSERT(table->NumFree() == 0);
+    table->Pin(0);
+    table->Pin(0);
+    table->Unpin(0);
+    ASSERT(table->IsPinned(0));
+    table->Unpin(0);
+    ASSERT(table->Victim() == 1);	// never freed, so the oldest
+    table->Reuse(1, NULL, n);
+    table->Pin(2);
+    ASSERT(table->Victim() == 4);	// 3 was freed, so is younger
+    table->Unpin(2);
+    ASSERT(table->Victim() == 2);
+    for (i = 0; i < n; i++) {
+	table->Free(i);
+    }
+    ASSERT(table->NumFree() == n && table->IsFree(0));
+    ASSERT(table->Victim() == -1 && table->Allocate(NULL, 0) == 0);
+    delete table;
+}
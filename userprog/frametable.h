@@ -0,0 +1,99 @@
+// frametable.h
+//	Data structures to keep track of the frames (pages) of physical
+//	memory: which ones are free, and what is in the others.
+//
+//	Free frames are found with a bitmap, a word at a time: each word
+//	of the bitmap covers 64 frames, and the host's "find first set"
+//	instruction picks out a free one.  We remember the first word
+//	that might have a free frame, so allocating doesn't look at the
+//	words that are all in use.  Like the old scan of
+//	kernel->usedPhysPage, this always hands out the lowest numbered
+//	free frame.
+//
+//	When there is no free frame, the frame table's replacement policy
+//	chooses one to take from its owner (see replacement.h).
+//
+//	After a Fork, a frame can belong to several address spaces at once,
+//	each mapping it read-only at the same virtual page until it writes
+//	the page and gets a copy of its own (copy-on-write).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FRAMETABLE_H
+#define FRAMETABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "list.h"
+#include "replacement.h"
+
+class AddrSpace;
+
+// What is in one frame of physical memory.
+
+class FrameInfo {
+  public:
+    AddrSpace *owner;		// address space the frame belongs to, or
+				// NULL if it is free or shared
+    bool shared;		// the frame holds a page of program text,
+				// which belongs to the page cache
+    List<AddrSpace *> *sharers;	// if not NULL, the address spaces that
+				// share the frame copy-on-write
+    int virtualPage;		// the owner's virtual page in the frame
+    int pinCount;		// if > 0, the frame mustn't be taken away
+				// from its owner (eg, I/O is in progress)
+};
+
+// The following class defines the frame table: an entry for every
+// frame of physical memory, plus a bitmap of the free ones.
+
+class FrameTable {
+  public:
+    FrameTable(int nFrames, ReplacementPolicy *replacement);
+					// all frames start out free
+    ~FrameTable();
+
+    int Allocate(AddrSpace *owner, int virtualPage);
+					// take a free frame for "owner";
+					// returns -1 if there is none
+    void Free(int frame);		// give a frame back
+
+    int NumFree() { return numFree; }
+    bool IsFree(int frame);
+    FrameInfo *Info(int frame);		// what is in "frame"
+
+    int Victim() { return policy->Victim(this); }
+					// a frame in use to take from its
+					// owner; -1 if they are all pinned
+    void Reuse(int frame, AddrSpace *owner, int virtualPage);
+					// give the victim to "owner"
+    bool Referenced(int frame);		// has the page in "frame" been used
+					// since we last asked?
+
+    void Share(int frame, AddrSpace *space);
+					// "space" maps "frame" copy-on-write,
+					// as well as its owner
+    void Unshare(int frame, AddrSpace *space);
+					// "space" no longer maps it
+
+    void Pin(int frame);		// keep a frame where it is
+    void Unpin(int frame);
+    bool IsPinned(int frame) { return Info(frame)->pinCount > 0; }
+
+    static void SelfTest();		// test whether it is working
+
+  private:
+    int numFrames;
+    FrameInfo *frames;			// indexed by frame number
+    unsigned long long *freeMap;	// bit i of word w set iff frame
+					// 64*w + i is free
+    int numWords;			// words in "freeMap"
+    int firstFreeWord;			// no free frames in the words
+					// before this one
+    int numFree;			// frames that are free
+    ReplacementPolicy *policy;		// chooses the victims
+};
+
+#endif // FRAMETABLE_H
@@ -14,10 +14,12 @@
 #include "kernel.h"
 
 #include "synchconsole.h"
+#include "synchdisk.h"
 
 
 void SysHalt()
 {
+  kernel->synchDisk->Flush();	// the disk cache may have dirty sectors
   kernel->interrupt->Halt();
 }
 
@@ -33,6 +35,11 @@ int SysAdd(int op1, int op2)
   return op1 + op2;
 }
 
+SpaceId SysFork()
+{
+  return kernel->Fork();
+}
+
 int SysCreate(char *filename)
 {
 	// return value
@@ -63,6 +70,27 @@ int SysClose(OpenFileId id)
 {
   return kernel->fileSystem->CloseFile(id);
 }
+
+int SysMmap(OpenFileId id, int length)
+{
+  OpenFile *file = kernel->fileSystem->DuplicateFile(id);
+  int addr;
+
+  if (file == NULL) return -1;
+  addr = kernel->currentThread->space->Mmap(file, length);
+  if (addr == -1) delete file;
+  return addr;
+}
+
+int SysMunmap(int addr)
+{
+  return kernel->currentThread->space->Munmap(addr) ? 1 : -1;
+}
+
+void SysSync()
+{
+  kernel->synchDisk->Flush();
+}
 // *************** MP1 *************** //
 
 #endif /* ! __USERPROG_KSYSCALL_H__ */
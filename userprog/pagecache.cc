@@ -0,0 +1,228 @@
+// pagecache.cc
+//	Routines to share the text pages of executables between the
+//	address spaces running them.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "pagecache.h"
+#include "addrspace.h"
+#include "frametable.h"
+
+//----------------------------------------------------------------------
+// Key, GetKey, HashKey
+// 	A cached page is known by its executable and virtual page, packed
+//	into one integer, so it can go in a HashTable.
+//----------------------------------------------------------------------
+
+static int
+Key(int exec, int vpn)
+{
+    ASSERT(vpn >= 0 && vpn < (1 << 16));
+    return (exec << 16) | vpn;
+}
+
+static int
+GetKey(CachedPage *page)
+{
+    return page->key;
+}
+
+static unsigned int
+HashKey(int key)
+{
+    return (unsigned int) key;
+}
+
+//----------------------------------------------------------------------
+// CachedPage::CachedPage
+// 	Page "vpn" of executable "exec" has been read into frame "f".
+//----------------------------------------------------------------------
+
+CachedPage::CachedPage(int exec, int vpn, int f)
+{
+    key = Key(exec, vpn);
+    virtualPage = vpn;
+    frame = f;
+    sharers = new List<AddrSpace *>;
+}
+
+CachedPage::~CachedPage()
+{
+    delete sharers;
+}
+
+//----------------------------------------------------------------------
+// PageCache::PageCache
+// 	Initialize an empty cache, for a memory of "nFrames" frames.
+//----------------------------------------------------------------------
+
+PageCache::PageCache(int nFrames)
+{
+    numFrames = nFrames;
+    executables = new List<char *>;
+    pages = new HashTable<int, CachedPage *>(GetKey, HashKey);
+    pageInFrame = new CachedPage *[numFrames];
+    for (int i = 0; i < numFrames; i++) {
+	pageInFrame[i] = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// PageCache::~PageCache
+//----------------------------------------------------------------------
+
+PageCache::~PageCache()
+{
+    for (int i = 0; i < numFrames; i++) {
+	if (pageInFrame[i] != NULL) {
+	    pages->Remove(pageInFrame[i]->key);
+	    delete pageInFrame[i];
+	}
+    }
+    while (!executables->IsEmpty()) {
+	delete [] executables->RemoveFront();
+    }
+    delete pages;
+    delete executables;
+    delete [] pageInFrame;
+}
+
+//----------------------------------------------------------------------
+// PageCache::ExecutableID
+// 	Return the number we know the executable "fileName" by, making
+//	up a new one if we haven't seen it before.
+//----------------------------------------------------------------------
+
+int
+PageCache::ExecutableID(char *fileName)
+{
+    ListIterator<char *> iter(executables);
+    int id = 0;
+    char *copy;
+
+    for (; !iter.IsDone(); iter.Next(), id++) {
+	if (strcmp(iter.Item(), fileName) == 0) {
+	    return id;
+	}
+    }
+    copy = new char[strlen(fileName) + 1];
+    strcpy(copy, fileName);
+    executables->Append(copy);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// PageCache::Share
+// 	If page "vpn" of executable "exec" is in the cache, count "space"
+//	as one of the address spaces mapping it, and return its frame.
+//	Otherwise return -1; "space" has to read the page itself, and Add
+//	it.
+//----------------------------------------------------------------------
+
+int
+PageCache::Share(AddrSpace *space, int exec, int vpn)
+{
+    CachedPage *page;
+
+    if (!pages->Find(Key(exec, vpn), &page)) {
+	return -1;
+    }
+    page->sharers->Append(space);
+    DEBUG(dbgAddr, "Sharing text page " << vpn << " in frame " << page->frame);
+    return page->frame;
+}
+
+//----------------------------------------------------------------------
+// PageCache::Add
+// 	"space" has read page "vpn" of executable "exec" into "frame".
+//	Put it in the cache, where the frame belongs to the cache rather
+//	than to "space", and count "space" as mapping it.
+//
+//	Reading the page may have blocked, and another address space may
+//	have cached the same page in the meantime.  Then we give "frame"
+//	back, and return the frame the page is in already.
+//----------------------------------------------------------------------
+
+int
+PageCache::Add(AddrSpace *space, int exec, int vpn, int frame)
+{
+    CachedPage *page;
+    FrameInfo *info;
+
+    if (pages->Find(Key(exec, vpn), &page)) {
+	kernel->frameTable->Free(frame);
+    } else {
+	page = new CachedPage(exec, vpn, frame);
+	pages->Insert(page);
+	pageInFrame[frame] = page;
+	info = kernel->frameTable->Info(frame);
+	info->owner = NULL;
+	info->shared = TRUE;
+	DEBUG(dbgAddr, "Caching text page " << vpn << " in frame " << frame);
+    }
+    page->sharers->Append(space);
+    return page->frame;
+}
+
+//----------------------------------------------------------------------
+// PageCache::Release
+// 	"space" no longer maps the cached page in "frame".  The page stays
+//	in the cache.
+//----------------------------------------------------------------------
+
+void
+PageCache::Release(AddrSpace *space, int frame)
+{
+    CachedPage *page = pageInFrame[frame];
+
+    ASSERT(page != NULL && page->sharers->IsInList(space));
+    page->sharers->Remove(space);
+}
+
+//----------------------------------------------------------------------
+// PageCache::Referenced
+// 	Return whether anybody has used the cached page in "frame" since
+//	the last time we asked, clearing all their use bits.
+//----------------------------------------------------------------------
+
+bool
+PageCache::Referenced(int frame)
+{
+    CachedPage *page = pageInFrame[frame];
+    ListIterator<AddrSpace *> iter(page->sharers);
+    bool used = FALSE;
+
+    for (; !iter.IsDone(); iter.Next()) {
+	if (iter.Item()->TestAndClearUse(page->virtualPage)) {
+	    used = TRUE;
+	}
+    }
+    return used;
+}
+
+//----------------------------------------------------------------------
+// PageCache::Evict
+// 	The replacement policy has given the frame of a cached page to
+//	someone else.  Take the page out of every address space mapping
+//	it, and out of the cache.  It is never dirty, so there is nothing
+//	to write back; it will be read from the executable again.
+//----------------------------------------------------------------------
+
+void
+PageCache::Evict(int frame)
+{
+    CachedPage *page = pageInFrame[frame];
+
+    DEBUG(dbgAddr, "Evicting text page " << page->virtualPage
+		<< " from frame " << frame);
+    while (!page->sharers->IsEmpty()) {
+	page->sharers->RemoveFront()->Unmap(page->virtualPage);
+    }
+    pages->Remove(page->key);
+    pageInFrame[frame] = NULL;
+    delete page;
+}
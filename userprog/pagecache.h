@@ -0,0 +1,76 @@
+// pagecache.h
+//	Data structures for the kernel's cache of program text: the pages
+//	of executables that hold nothing but code and read-only data.
+//
+//	Those pages are never written, so every address space running the
+//	same executable can map the same frame, read-only.  The cache is
+//	keyed by executable and virtual page, and remembers which address
+//	spaces have each page mapped.  A page stays in the cache after the
+//	last of them exits, so running the program again doesn't read it
+//	again; its frame goes when the replacement policy picks it, like
+//	any other.
+//
+//	Executables are told apart by name, and are assumed not to change
+//	while Nachos is running.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "hash.h"
+
+class AddrSpace;
+
+// One page of an executable, in memory.
+
+class CachedPage {
+  public:
+    CachedPage(int exec, int vpn, int f);
+    ~CachedPage();
+
+    int key;			// executable and virtual page; see Key
+    int virtualPage;
+    int frame;			// where it is in memory
+    List<AddrSpace *> *sharers;	// address spaces that have it mapped
+};
+
+// The following class defines the page cache.
+
+class PageCache {
+  public:
+    PageCache(int nFrames);
+    ~PageCache();
+
+    int ExecutableID(char *fileName);	// number the cache knows an
+					// executable by
+
+    int Share(AddrSpace *space, int exec, int vpn);
+					// map page "vpn" of executable
+					// "exec" into "space"; returns its
+					// frame, or -1 if it isn't cached
+    int Add(AddrSpace *space, int exec, int vpn, int frame);
+					// "space" has read the page into
+					// "frame"; cache it, and map it.
+					// Returns the frame to use, which is
+					// another one if the page got cached
+					// meanwhile
+    void Release(AddrSpace *space, int frame);
+					// "space" is done with it
+
+    bool Referenced(int frame);		// used by anyone since we asked?
+    void Evict(int frame);		// unmap it everywhere, and forget it
+
+  private:
+    int numFrames;			// size of physical memory
+    List<char *> *executables;		// names, indexed by ID
+    HashTable<int, CachedPage *> *pages;	// cached pages, by key
+    CachedPage **pageInFrame;		// the cached page in each frame, or
+					// NULL
+};
+
+#endif // PAGECACHE_H
@@ -0,0 +1,251 @@
+// pagetable.cc
+//	Routines to find, add and remove the entries of a sparse, two
+//	level page table.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "machine.h"
+#include "pagetable.h"
+
+//----------------------------------------------------------------------
+// LeafNumber, HashLeaf
+// 	Leaves are kept in a HashTable, by number.
+//----------------------------------------------------------------------
+
+static int
+LeafNumber(PageTableLeaf *leaf)
+{
+    return leaf->number;
+}
+
+static unsigned int
+HashLeaf(int number)
+{
+    return (unsigned int) number;
+}
+
+//----------------------------------------------------------------------
+// PageTableLeaf::PageTableLeaf
+// 	Initialize leaf "n", with none of its entries in use.
+//----------------------------------------------------------------------
+
+PageTableLeaf::PageTableLeaf(int n)
+{
+    number = n;
+    numEntries = 0;
+    for (int i = 0; i < PageTableLeafSize; i++) {
+	entries[i].translation.virtualPage = -1;
+	entries[i].translation.valid = FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// PageTable::PageTable
+// 	Initialize an empty page table.
+//----------------------------------------------------------------------
+
+PageTable::PageTable()
+{
+    leaves = new HashTable<int, PageTableLeaf *>(LeafNumber, HashLeaf);
+    lastLeaf = NULL;
+    numEntries = 0;
+}
+
+//----------------------------------------------------------------------
+// PageTable::~PageTable
+// 	Deallocate the page table, and whatever leaves it still has.
+//----------------------------------------------------------------------
+
+PageTable::~PageTable()
+{
+    while (!leaves->IsEmpty()) {
+	HashIterator<int, PageTableLeaf *> iter(leaves);
+
+	delete leaves->Remove(iter.Item()->number);
+    }
+    delete leaves;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Find
+// 	Return the entry for virtual page "vpn", or NULL if the page isn't
+//	in the table.
+//----------------------------------------------------------------------
+
+PageEntry *
+PageTable::Find(unsigned int vpn)
+{
+    int number = vpn / PageTableLeafSize;
+    PageEntry *entry;
+
+    if (lastLeaf == NULL || lastLeaf->number != number) {
+	if (!leaves->Find(number, &lastLeaf)) {
+	    lastLeaf = NULL;
+	    return NULL;
+	}
+    }
+    entry = &lastLeaf->entries[vpn % PageTableLeafSize];
+    return (entry->translation.virtualPage == -1) ? NULL : entry;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Add
+// 	Put virtual page "vpn" in the table, making a leaf for it if need
+//	be, and return its entry: invalid, and with no swap page.
+//----------------------------------------------------------------------
+
+PageEntry *
+PageTable::Add(unsigned int vpn)
+{
+    int number = vpn / PageTableLeafSize;
+    PageTableLeaf *leaf;
+    PageEntry *entry;
+
+    if (!leaves->Find(number, &leaf)) {
+	leaf = new PageTableLeaf(number);
+	leaves->Insert(leaf);
+    }
+    entry = &leaf->entries[vpn % PageTableLeafSize];
+    ASSERT(entry->translation.virtualPage == -1);
+    entry->translation.virtualPage = vpn;
+    entry->translation.physicalPage = -1;
+    entry->translation.valid = FALSE;
+    entry->translation.use = FALSE;
+    entry->translation.dirty = FALSE;
+    entry->translation.readOnly = FALSE;
+    entry->swapPage = -1;
+    entry->inSwap = FALSE;
+    leaf->numEntries++;
+    numEntries++;
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Remove
+// 	Take virtual page "vpn" out of the table, and its leaf too, if it
+//	was the last page in it.  The page mustn't be valid.
+//----------------------------------------------------------------------
+
+void
+PageTable::Remove(unsigned int vpn)
+{
+    int number = vpn / PageTableLeafSize;
+    PageTableLeaf *leaf;
+    PageEntry *entry;
+    bool found = leaves->Find(number, &leaf);
+
+    ASSERT(found);
+    entry = &leaf->entries[vpn % PageTableLeafSize];
+    ASSERT(entry->translation.virtualPage != -1
+		&& !entry->translation.valid);
+    entry->translation.virtualPage = -1;
+    numEntries--;
+    if (--leaf->numEntries == 0) {
+	leaves->Remove(number);
+	if (lastLeaf == leaf) {
+	    lastLeaf = NULL;
+	}
+	delete leaf;
+    }
+}
+
+//----------------------------------------------------------------------
+// PageTableIterator::PageTableIterator
+// 	Start at the first entry in use in "table".
+//----------------------------------------------------------------------
+
+PageTableIterator::PageTableIterator(PageTable *table)
+{
+    leafIter = new HashIterator<int, PageTableLeaf *>(table->leaves);
+    index = 0;
+    SkipUnused();
+}
+
+PageTableIterator::~PageTableIterator()
+{
+    delete leafIter;
+}
+
+//----------------------------------------------------------------------
+// PageTableIterator::Item, PageTableIterator::Next
+// 	Return the current entry, or step to the next one in use.
+//----------------------------------------------------------------------
+
+PageEntry *
+PageTableIterator::Item()
+{
+    return &leafIter->Item()->entries[index];
+}
+
+void
+PageTableIterator::Next()
+{
+    index++;
+    SkipUnused();
+}
+
+//----------------------------------------------------------------------
+// PageTableIterator::SkipUnused
+// 	Move on from the current entry, if it isn't in use, to the next
+//	one that is, going on to the next leaf when this one runs out.
+//----------------------------------------------------------------------
+
+void
+PageTableIterator::SkipUnused()
+{
+    while (!leafIter->IsDone()) {
+	PageTableLeaf *leaf = leafIter->Item();
+
+	for (; index < PageTableLeafSize; index++) {
+	    if (leaf->entries[index].translation.virtualPage != -1) {
+		return;
+	    }
+	}
+	leafIter->Next();
+	index = 0;
+    }
+}
+
+//----------------------------------------------------------------------
+// PageTable::SelfTest
+// 	Put a few pages at the bottom of a 4GB address space, and a few
+//	at the top, and check that only they are there, and that only
+//	the leaves they need are made.  Then take them out again.
+//----------------------------------------------------------------------
+
+void
+PageTable::SelfTest()
+{
+    PageTable *table = new PageTable;
+    const unsigned int top = 0xffffffff / PageSize;	// last page of 4GB
+    int count = 0;
+
+    for (unsigned int vpn = 0; vpn < 40; vpn++) {
+	table->Add(vpn)->swapPage = vpn;
+    }
+    for (unsigned int vpn = top - 7; vpn <= top; vpn++) {
+	table->Add(vpn);
+    }
+    ASSERT(table->NumEntries() == 48 && table->leaves->IsInTable(1)
+		&& !table->leaves->IsInTable(2));
+    ASSERT(table->Find(39)->swapPage == 39);
+    ASSERT(table->Find(40) == NULL && table->Find(top - 8) == NULL);
+    ASSERT(table->Translation(top)->virtualPage == (int) top);
+
+    for (PageTableIterator iter(table); !iter.IsDone(); iter.Next()) {
+	ASSERT(!iter.Item()->translation.valid);
+	count++;
+    }
+    ASSERT(count == 48);
+
+    for (unsigned int vpn = 32; vpn < 40; vpn++) {
+	table->Remove(vpn);
+    }
+    ASSERT(!table->leaves->IsInTable(1) && table->Find(35) == NULL);
+    ASSERT(table->Find(31) != NULL);
+    delete table;
+}
@@ -0,0 +1,110 @@
+// pagetable.h
+//	Data structures for the page table of an address space.
+//
+//	The page table only has entries for the pages that are in the
+//	address space, so it can be sparse: a program at the bottom of
+//	user space, its stack at the top, and mapped files in between take
+//	no more room than their pages need.
+//
+//	It has two levels.  The entries are kept in leaves, each covering
+//	PageTableLeafSize consecutive virtual pages; a hash table finds
+//	the leaf for a virtual page.  A leaf is made when the first page
+//	in it is added, and goes when the last one is removed.
+//
+//	When the machine translates through a page table rather than a
+//	TLB, it looks up the translation here (see Machine::Translate).
+//	Next to the translation, each entry holds what the kernel needs to
+//	know about the page when it isn't in memory.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+#include "copyright.h"
+#include "translate.h"
+#include "hash.h"
+
+const int PageTableLeafSize = 32;	// virtual pages covered by a leaf
+
+// The page table entry for one virtual page.
+
+class PageEntry {
+  public:
+    TranslationEntry translation;	// what the machine uses
+    int swapPage;		// where the page goes in the swap space,
+				// or -1 if it doesn't (a mapped file's)
+    bool inSwap;		// TRUE if it has been written there, so
+				// must be read from there
+};
+
+// The entries for PageTableLeafSize consecutive virtual pages, some
+// of which may not be in the address space.
+
+class PageTableLeaf {
+  public:
+    PageTableLeaf(int n);
+
+    int number;			// covers pages from number *
+				// PageTableLeafSize on
+    int numEntries;		// how many of them are in use
+    PageEntry entries[PageTableLeafSize];
+				// unused ones have virtualPage -1
+};
+
+class PageTableIterator;
+
+// The following class defines a page table.
+
+class PageTable {
+  public:
+    PageTable();			// an empty table
+    ~PageTable();
+
+    PageEntry *Find(unsigned int vpn);	// the entry for "vpn", or NULL
+					// if it isn't in the table
+    PageEntry *Add(unsigned int vpn);	// put "vpn" in the table,
+					// invalid, with no swap page
+    void Remove(unsigned int vpn);	// take it out again
+
+    TranslationEntry *Translation(unsigned int vpn) {
+	PageEntry *entry = Find(vpn);
+
+	return (entry == NULL) ? NULL : &entry->translation;
+    }					// the machine's view
+
+    int NumEntries() { return numEntries; }
+
+    static void SelfTest();		// test whether it is working
+
+  private:
+    HashTable<int, PageTableLeaf *> *leaves;	// by leaf number
+    PageTableLeaf *lastLeaf;		// the leaf Find found last;
+					// programs mostly stay in one
+    int numEntries;			// pages in the table
+
+    friend class PageTableIterator;
+};
+
+// The following class steps through the entries of a page table, in
+// no particular order -- same interface as ListIterator.  Entries may
+// be changed along the way, but not added or removed.
+
+class PageTableIterator {
+  public:
+    PageTableIterator(PageTable *table);
+    ~PageTableIterator();
+
+    bool IsDone() { return leafIter->IsDone(); }
+    PageEntry *Item();			// current entry
+    void Next();			// step to the next one
+
+  private:
+    HashIterator<int, PageTableLeaf *> *leafIter;
+    int index;				// entry in the current leaf
+    void SkipUnused();			// move past unused entries
+};
+
+#endif // PAGETABLE_H
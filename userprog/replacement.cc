@@ -0,0 +1,191 @@
+// replacement.cc
+//	Routines to choose which page to push out of memory, when a page
+//	fault finds every frame in use.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "replacement.h"
+#include "frametable.h"
+
+const unsigned int RecentlyUsed = 1U << 31;	// top bit of an age
+
+//----------------------------------------------------------------------
+// ReplacementPolicy::Create
+// 	Make a policy of the given type, for "nFrames" frames of memory.
+//----------------------------------------------------------------------
+
+ReplacementPolicy *
+ReplacementPolicy::Create(ReplacementType type, int nFrames)
+{
+    switch (type) {
+      case FIFOReplacement:  return new FIFOReplacementPolicy(nFrames);
+      case ClockReplacement: return new ClockReplacementPolicy(nFrames);
+      case LRUReplacement:   return new LRUReplacementPolicy(nFrames);
+    }
+    ASSERTNOTREACHED();
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ReplacementPolicy::ParseType
+// 	Convert the name of a policy, as given to "-rep", into its type.
+//	Returns FALSE if there is no such policy.
+//----------------------------------------------------------------------
+
+bool
+ReplacementPolicy::ParseType(char *name, ReplacementType *type)
+{
+    if (strcmp(name, "fifo") == 0) {
+	*type = FIFOReplacement;
+    } else if (strcmp(name, "clock") == 0) {
+	*type = ClockReplacement;
+    } else if (strcmp(name, "lru") == 0) {
+	*type = LRUReplacement;
+    } else {
+	return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FIFOReplacementPolicy::FIFOReplacementPolicy
+//----------------------------------------------------------------------
+
+FIFOReplacementPolicy::FIFOReplacementPolicy(int nFrames)
+	: ReplacementPolicy(nFrames)
+{
+    loadedAt = new unsigned int[numFrames];
+    for (int i = 0; i < numFrames; i++) {
+	loadedAt[i] = 0;
+    }
+    numLoaded = 0;
+}
+
+FIFOReplacementPolicy::~FIFOReplacementPolicy()
+{
+    delete [] loadedAt;
+}
+
+//----------------------------------------------------------------------
+// FIFOReplacementPolicy::Loaded
+// 	Remember when "frame" got its page.
+//----------------------------------------------------------------------
+
+void
+FIFOReplacementPolicy::Loaded(int frame)
+{
+    loadedAt[frame] = ++numLoaded;
+}
+
+//----------------------------------------------------------------------
+// FIFOReplacementPolicy::Victim
+// 	Choose the frame whose page was loaded first.
+//----------------------------------------------------------------------
+
+int
+FIFOReplacementPolicy::Victim(FrameTable *table)
+{
+    int victim = -1;
+
+    for (int frame = 0; frame < numFrames; frame++) {
+	if (!table->IsFree(frame) && !table->IsPinned(frame)
+		&& (victim == -1 || loadedAt[frame] < loadedAt[victim])) {
+	    victim = frame;
+	}
+    }
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// ClockReplacementPolicy::ClockReplacementPolicy
+//----------------------------------------------------------------------
+
+ClockReplacementPolicy::ClockReplacementPolicy(int nFrames)
+	: ReplacementPolicy(nFrames)
+{
+    hand = 0;
+}
+
+//----------------------------------------------------------------------
+// ClockReplacementPolicy::Victim
+// 	Advance the hand to the first page that hasn't been used since
+//	the last time round, clearing the use bits on the way.  After one
+//	full turn every use bit is clear, so two turns are enough, unless
+//	every frame is pinned.
+//----------------------------------------------------------------------
+
+int
+ClockReplacementPolicy::Victim(FrameTable *table)
+{
+    for (int i = 0; i < 2 * numFrames; i++) {
+	int frame = hand;
+
+	hand = (hand + 1) % numFrames;
+	if (!table->IsFree(frame) && !table->IsPinned(frame)
+		&& !table->Referenced(frame)) {
+	    return frame;
+	}
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// LRUReplacementPolicy::LRUReplacementPolicy
+//----------------------------------------------------------------------
+
+LRUReplacementPolicy::LRUReplacementPolicy(int nFrames)
+	: ReplacementPolicy(nFrames)
+{
+    age = new unsigned int[numFrames];
+    for (int i = 0; i < numFrames; i++) {
+	age[i] = 0;
+    }
+}
+
+LRUReplacementPolicy::~LRUReplacementPolicy()
+{
+    delete [] age;
+}
+
+//----------------------------------------------------------------------
+// LRUReplacementPolicy::Loaded
+// 	A page that was just loaded is about to be used, so count it as
+//	recently used; otherwise it would be the first to go.
+//----------------------------------------------------------------------
+
+void
+LRUReplacementPolicy::Loaded(int frame)
+{
+    age[frame] = RecentlyUsed;
+}
+
+//----------------------------------------------------------------------
+// LRUReplacementPolicy::Victim
+// 	Age every page in memory, and choose the oldest that isn't
+//	pinned.  Pinned pages are aged too, so their ages stay comparable.
+//----------------------------------------------------------------------
+
+int
+LRUReplacementPolicy::Victim(FrameTable *table)
+{
+    int victim = -1;
+
+    for (int frame = 0; frame < numFrames; frame++) {
+	if (table->IsFree(frame)) {
+	    continue;
+	}
+	age[frame] >>= 1;
+	if (table->Referenced(frame)) {
+	    age[frame] |= RecentlyUsed;
+	}
+	if (!table->IsPinned(frame)
+		&& (victim == -1 || age[frame] < age[victim])) {
+	    victim = frame;
+	}
+    }
+    return victim;
+}
@@ -0,0 +1,107 @@
+// replacement.h
+//	Data structures for the page replacement policies: the ways of
+//	choosing which page to push out of memory when a page fault
+//	needs a frame and there are no free ones.
+//
+//	A policy only picks the frame.  It never takes a pinned frame,
+//	and it learns whether a page has been used recently from the use
+//	bits the hardware sets in the page table (or TLB), by asking the
+//	frame table (see FrameTable::Referenced), which clears the bit
+//	again.  Pushing the page out, and writing it to the swap space if
+//	it is dirty, is up to the address space it belongs to.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include "copyright.h"
+
+class FrameTable;
+
+// The policies the kernel can be booted with (see "-rep").
+enum ReplacementType { FIFOReplacement, ClockReplacement, LRUReplacement };
+
+// The following class defines the interface every replacement policy
+// provides.
+
+class ReplacementPolicy {
+  public:
+    ReplacementPolicy(int nFrames) { numFrames = nFrames; }
+    virtual ~ReplacementPolicy() {}
+
+    virtual char *getName() = 0;	// for debugging
+
+    virtual void Loaded(int frame) {}	// a page was just put in "frame"
+    virtual int Victim(FrameTable *table) = 0;
+					// choose a frame that is in use,
+					// but not pinned; -1 if there is
+					// none
+
+    static ReplacementPolicy *Create(ReplacementType type, int nFrames);
+				// make a policy of the given type
+    static bool ParseType(char *name, ReplacementType *type);
+				// name given to "-rep" -> policy type
+
+  protected:
+    int numFrames;		// size of physical memory
+};
+
+// First in, first out: push out the page that has been in memory the
+// longest, whether or not it is still being used.
+
+class FIFOReplacementPolicy : public ReplacementPolicy {
+  public:
+    FIFOReplacementPolicy(int nFrames);
+    ~FIFOReplacementPolicy();
+
+    char *getName() { return "fifo"; }
+
+    void Loaded(int frame);
+    int Victim(FrameTable *table);
+
+  private:
+    unsigned int *loadedAt;	// for each frame, when its page came in
+    unsigned int numLoaded;	// pages loaded so far
+};
+
+// Clock, or second chance: sweep a hand around the frames, and push out
+// the first page that hasn't been used since the hand last passed it.
+// Pages that have been used get their use bit cleared, and a second
+// chance.
+
+class ClockReplacementPolicy : public ReplacementPolicy {
+  public:
+    ClockReplacementPolicy(int nFrames);
+
+    char *getName() { return "clock"; }
+
+    int Victim(FrameTable *table);
+
+  private:
+    int hand;			// the next frame to look at
+};
+
+// Least recently used, approximated by aging: each time we need a
+// victim, every page's age is shifted right one bit, and its use bit
+// (which is then cleared) is shifted in at the top.  The page with the
+// lowest age hasn't been used for the most page faults.
+
+class LRUReplacementPolicy : public ReplacementPolicy {
+  public:
+    LRUReplacementPolicy(int nFrames);
+    ~LRUReplacementPolicy();
+
+    char *getName() { return "lru"; }
+
+    void Loaded(int frame);
+    int Victim(FrameTable *table);
+
+  private:
+    unsigned int *age;		// use bits of each frame, most recent
+				// page fault in the top bit
+};
+
+#endif // REPLACEMENT_H
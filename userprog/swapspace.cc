@@ -0,0 +1,133 @@
+// swapspace.cc
+//	Routines to allocate pages of swap space, and to move pages
+//	between it and physical memory.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "swapspace.h"
+#include "synchdisk.h"
+#include "admission.h"
+
+//----------------------------------------------------------------------
+// SwapSpace::SwapSpace
+// 	Initialize the swap space, with every page free.
+//----------------------------------------------------------------------
+
+SwapSpace::SwapSpace()
+{
+    ASSERT(PageSize == SectorSize);	// a page fits in a sector
+    freeMap = new Bitmap(NumSwapPages);
+    writing = new Bitmap(NumSwapPages);
+    freed = new Bitmap(NumSwapPages);
+    lock = new Lock("swap space");
+    written = new Condition("swap page written");
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::~SwapSpace
+//----------------------------------------------------------------------
+
+SwapSpace::~SwapSpace()
+{
+    delete freeMap;
+    delete writing;
+    delete freed;
+    delete lock;
+    delete written;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Allocate, SwapSpace::Free
+// 	Take a swap page, or give one back.  If the page is still being
+//	written, it only becomes free once the write is done; otherwise
+//	the write could land on top of the next owner's data.
+//----------------------------------------------------------------------
+
+int
+SwapSpace::Allocate()
+{
+    return freeMap->FindAndSet();
+}
+
+void
+SwapSpace::Free(int page)
+{
+    ASSERT(freeMap->Test(page));
+    if (writing->Test(page)) {
+	freed->Mark(page);
+    } else {
+	freeMap->Clear(page);
+    }
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::ReadPage
+// 	Read swap page "page" into physical frame "frame", after waiting
+//	for any write to it to finish.
+//----------------------------------------------------------------------
+
+void
+SwapSpace::ReadPage(int page, int frame)
+{
+    lock->Acquire();
+    while (writing->Test(page)) {
+	written->Wait(lock);
+    }
+    lock->Release();
+    DEBUG(dbgAddr, "Reading swap page " << page << " into frame " << frame);
+    kernel->stats->numSwapReads++;
+    kernel->synchDisk->ReadSector(FirstSwapSector + page,
+		&kernel->machine->mainMemory[frame * PageSize]);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::BeginWrite
+// 	Mark swap page "page" as being written, before the write starts.
+//	From now on a read of it waits for the write, and if its owner
+//	gives it back, it stays in use until the write is done.
+//
+//	This doesn't switch threads, so the caller can mark several pages
+//	before any of them is written.
+//----------------------------------------------------------------------
+
+void
+SwapSpace::BeginWrite(int page)
+{
+    ASSERT(!writing->Test(page));
+    writing->Mark(page);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::WritePage
+// 	Write physical frame "frame" out to swap page "page", which
+//	BeginWrite has marked as being written, and clear the mark.
+//----------------------------------------------------------------------
+
+void
+SwapSpace::WritePage(int page, int frame)
+{
+    bool ownerGone;
+
+    ASSERT(writing->Test(page));
+    DEBUG(dbgAddr, "Writing frame " << frame << " to swap page " << page);
+    kernel->stats->numSwapWrites++;
+    kernel->synchDisk->WriteSector(FirstSwapSector + page,
+		&kernel->machine->mainMemory[frame * PageSize]);
+
+    lock->Acquire();
+    writing->Clear(page);
+    ownerGone = freed->Test(page);
+    if (ownerGone) {
+	freed->Clear(page);
+	freeMap->Clear(page);
+    }
+    written->Broadcast(lock);
+    lock->Release();
+    if (ownerGone) {
+	kernel->admissionQueue->Release();	// room for somebody waiting?
+    }
+}
@@ -0,0 +1,62 @@
+// swapspace.h
+//	Data structures for the swap space: the part of the disk that
+//	holds the pages of address spaces that have been pushed out of
+//	memory.
+//
+//	The swap space is the last NumSwapPages sectors of the disk (a
+//	page is the same size as a sector).  The stub file system doesn't
+//	use the disk at all; the real one keeps off those sectors when it
+//	formats the disk.
+//
+//	Each address space is given a swap page for every one of its
+//	virtual pages when it is loaded, so pushing a dirty page out of
+//	memory never fails for want of somewhere to put it.
+//
+//	A page can be read back in while it is still being written out
+//	(its owner faults on it again straight away).  The disk's lock
+//	doesn't promise to serve requests in order, so the read waits for
+//	the write itself.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAPSPACE_H
+#define SWAPSPACE_H
+
+#include "copyright.h"
+#include "bitmap.h"
+#include "disk.h"
+#include "synch.h"
+
+const int NumSwapPages = NumSectors / 2;	// the second half of the disk
+const int FirstSwapSector = NumSectors - NumSwapPages;
+
+// The following class defines the swap space.  Reading and writing a
+// page wait for the disk, so they may block the calling thread.
+
+class SwapSpace {
+  public:
+    SwapSpace();			// all swap pages start out free
+    ~SwapSpace();
+
+    int Allocate();			// take a free swap page; -1 if
+					// there is none
+    void Free(int page);		// give a swap page back (once it
+					// has finished being written)
+    int NumFree() { return freeMap->NumClear(); }
+
+    void ReadPage(int page, int frame);	// swap page -> physical memory
+    void BeginWrite(int page);		// "page" is about to be written
+    void WritePage(int page, int frame);	// physical memory -> swap page
+
+  private:
+    Bitmap *freeMap;			// swap pages in use
+    Bitmap *writing;			// swap pages being written
+    Bitmap *freed;			// ... and given back meanwhile
+    Lock *lock;				// held to wait for a write, or
+					// to say one has finished
+    Condition *written;			// signalled when a write finishes
+};
+
+#endif // SWAPSPACE_H
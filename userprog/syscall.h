@@ -37,6 +37,10 @@
 #define SC_ThreadExit   14
 #define SC_ThreadJoin   15
 #define SC_PrintInt     16
+#define SC_Fork		17
+#define SC_Mmap		18
+#define SC_Munmap	19
+#define SC_Sync		20
 #define SC_Add		42
 #define SC_MSG		100
 #ifndef IN_ASM
@@ -87,6 +91,12 @@ SpaceId Exec(char* exec_name);
  * address space identifier
  */
 SpaceId ExecV(int argc, char* argv[]);
+
+/* Make a copy of the calling program, which carries on from the
+ * return of Fork.  Return 0 in the copy, and its identifier in the
+ * caller; negative error code on failure.
+ */
+SpaceId Fork();
  
 /* Only return once the user program "id" has finished.  
  * Return the exit status.
@@ -153,6 +163,23 @@ int Seek(int position, OpenFileId id);
 int Close(OpenFileId id);
 
 
+/* Map the first "length" bytes of the open file "id" into memory.
+ * Return the address they start at, or -1 on failure.  The file stays
+ * mapped after it is closed, until Munmap; changes are written back.
+ */
+char *Mmap(OpenFileId id, int length);
+
+/* Write back and remove the mapping that starts at "addr".
+ * Return 1 on success, negative error code on failure.
+ */
+int Munmap(char *addr);
+
+/* Write everything written to files so far out to the disk, and return
+ * once it is there.  Writes otherwise only reach the disk a while later.
+ */
+void Sync();
+
+
 /* User-level thread operations: Fork and Yield.  To allow multiple
  * threads to run within a user program. 
  *